@@ -0,0 +1,333 @@
+// David Wilson - Code Sample
+
+#pragma once
+
+#include "Include1.h"
+#include "Include2.h"
+#include "Include3.h"
+
+#include "Params.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+
+
+//----------------------------------------------------------------------
+// t_batch_executor: Runs batch reports concurrently
+//----------------------------------------------------------------------
+
+// Runs one report per parameter on up to threads() workers. Reports must
+// only read the simulation, and must return their result. Results go to
+// the writer in parameter order, each as soon as it and all earlier
+// reports are done, so output matches a serial run. The writer runs only
+// on the calling thread, never on a worker. If a report or the writer
+// throws, earlier results are still written, later reports are not
+// started or are discarded, and the exception is rethrown to the caller
+// once all workers have stopped.
+
+class t_batch_executor
+{
+public:
+
+	// Zero threads means one per hardware thread
+	explicit t_batch_executor(unsigned threads = 0) :
+		m_threads(threads ? threads : std::max(std::thread::hardware_concurrency(), 1u))
+	{ }
+
+	unsigned threads() const		{ return m_threads; }
+
+	template<typename PARAM, typename RUN, typename WRITE>
+	void run(const std::vector<PARAM>& parameters, RUN run, WRITE write) const
+	{
+		using t_result = std::decay_t<decltype(run(parameters.front()))>;
+		static_assert(!std::is_void_v<t_result>,
+			"t_batch_executor: report must return a result for the writer, not void");
+
+		// Report state, by parameter index
+		const size_t count = parameters.size();
+		std::vector<std::optional<t_result>> results(count);
+		std::vector<std::exception_ptr> errors(count);
+		std::vector<char> done(count, 0);
+
+		std::atomic<size_t> next_run(0);
+		std::atomic<size_t> first_error(count);
+		std::mutex done_mutex;
+		std::condition_variable done_signal;
+
+		auto worker = [&]()
+		{
+			for (;;)
+			{
+				// Take next report, unless past a failed one
+				size_t index = next_run++;
+				if (index >= count || index > first_error) return;
+
+				std::optional<t_result> result;
+				std::exception_ptr error;
+				try
+				{
+					result.emplace(run(parameters[index]));
+				}
+				catch (...)
+				{
+					error = std::current_exception();
+					at_most_atomic(first_error, index);
+				}
+
+				// Hand result to writer
+				{
+					std::lock_guard<std::mutex> lock(done_mutex);
+					results[index] = std::move(result);
+					errors[index] = error;
+					done[index] = 1;
+				}
+				done_signal.notify_one();
+			}
+		};
+
+		// Run reports on workers
+		std::vector<std::thread> workers;
+		auto worker_count = std::min<size_t>(m_threads, count);
+		for (size_t i = 0; i < worker_count; ++i)
+			workers.emplace_back(worker);
+
+		// Write results on calling thread, in order, stopping at first failure.
+		// Every report up to first failure is taken, so each wait ends.
+		std::exception_ptr failure;
+		for (size_t index = 0; index < count && !failure; ++index)
+		{
+			std::optional<t_result> result;
+			{
+				std::unique_lock<std::mutex> lock(done_mutex);
+				done_signal.wait(lock, [&done, index] { return done[index] != 0; });
+				failure = errors[index];
+				result = std::move(results[index]);
+				results[index].reset();
+			}
+			if (failure) break;
+
+			try
+			{
+				write(parameters[index], std::move(*result));
+			}
+			catch (...)
+			{
+				failure = std::current_exception();
+				at_most_atomic(first_error, index);
+			}
+		}
+
+		for (auto& worker_thread : workers)
+			worker_thread.join();
+
+		if (failure)
+			std::rethrow_exception(failure);
+	}
+
+private:
+
+	static void at_most_atomic(std::atomic<size_t>& value, size_t limit)
+	{
+		for (size_t current = value; limit < current && !value.compare_exchange_weak(current, limit);)
+			;
+	}
+
+	unsigned						m_threads;
+};
+
+
+//----------------------------------------------------------------------
+// run_item_reports, run_list_reports
+//----------------------------------------------------------------------
+
+// Resolve batch query parameters, then run one report per parameter.
+
+template<typename FEAT, typename RUN, typename WRITE>
+void run_item_reports(
+	const t_batch_executor& executor,
+	const t_batch_query_param& query_param,
+	const typename t_param_traits<FEAT>::parameter_type& config_parameter,
+	const t_live_simulation& sim,
+	RUN run,
+	WRITE write
+)
+{
+	executor.run(get_item_parameters<FEAT>(query_param, config_parameter, sim), run, write);
+}
+
+template<typename FEAT, typename RUN, typename WRITE>
+void run_list_reports(
+	const t_batch_executor& executor,
+	const t_batch_query_param& query_param,
+	const typename t_param_traits<FEAT>::listparam_type& config_listparam,
+	bool config_all_parameters,
+	const t_live_simulation& sim,
+	RUN run,
+	WRITE write
+)
+{
+	executor.run(get_list_parameters<FEAT>(query_param, config_listparam, config_all_parameters, sim), run, write);
+}
+
+
+//----------------------------------------------------------------------
+// t_feature_list: Compile-time list of batch feature types
+//----------------------------------------------------------------------
+
+template<typename FEAT>
+struct t_feature_tag
+{
+	using type = FEAT;
+};
+
+template<typename... FEATS>
+struct t_feature_list
+{
+	static constexpr size_t size = sizeof...(FEATS);
+
+	// Position of FEAT in list
+	template<typename FEAT>
+	static constexpr size_t index()
+	{
+		constexpr bool matches[] = { std::is_same_v<FEAT, FEATS>..., false };
+		for (size_t i = 0; i < size; ++i)
+			if (matches[i]) return i;
+		return size;
+	}
+
+	template<typename FEAT>
+	static constexpr bool contains()
+	{ return index<FEAT>() < size; }
+
+	// Call func with t_feature_tag of feature type at runtime position
+	template<typename FUNC>
+	static void dispatch(size_t feature_index, FUNC&& func)
+	{
+		size_t i = 0;
+		((i++ == feature_index ? (func(t_feature_tag<FEATS>()), true) : false) || ...);
+	}
+};
+
+
+//----------------------------------------------------------------------
+// t_batch_planner: Resolves and shares batch query parameters
+//----------------------------------------------------------------------
+
+// Queries are grouped by feature type, at compile time, and by query
+// type. Each distinct parameter set is resolved once per simulation;
+// later queries for the same set share the same resolved vector. ALL
+// and SINGLE sets depend only on the simulation, so every report in a
+// batch using them shares one resolution.
+
+template<typename LIST>
+class t_batch_planner;
+
+template<typename... FEATS>
+class t_batch_planner<t_feature_list<FEATS...>>
+{
+public:
+
+	using feature_list = t_feature_list<FEATS...>;
+
+	template<typename FEAT>
+	using items_ptr = std::shared_ptr<const std::vector<typename t_param_traits<FEAT>::named_parameter_type>>;
+
+	template<typename FEAT>
+	using lists_ptr = std::shared_ptr<const std::vector<typename t_param_traits<FEAT>::named_listparam_type>>;
+
+	explicit t_batch_planner(const t_live_simulation& sim) :
+		m_sim(sim)
+	{ }
+
+	template<typename FEAT>
+	items_ptr<FEAT> item_parameters(
+		const t_batch_query_param& query_param,
+		const typename t_param_traits<FEAT>::parameter_type& config_parameter
+	)
+	{
+		using traits = t_param_traits<FEAT>;
+		auto type = query_param.type();
+		bool explicit_query = type == t_batch_query_param::t_type::EXPLICIT;
+		bool config_query = type == t_batch_query_param::t_type::CONFIG;
+
+		// Key on only what the query type reads
+		typename t_cache<FEAT>::t_item_key key(
+			type,
+			explicit_query ? query_param.m_values : t_string_list(),
+			config_query ? config_parameter : typename traits::parameter_type()
+		);
+		++m_requests;
+		auto& entry = cache<FEAT>().m_items[key];
+		if (!entry)
+		{
+			entry = std::make_shared<const typename items_ptr<FEAT>::element_type>(
+				get_item_parameters<FEAT>(query_param, config_parameter, m_sim));
+			++m_resolved;
+		}
+		return entry;
+	}
+
+	template<typename FEAT>
+	lists_ptr<FEAT> list_parameters(
+		const t_batch_query_param& query_param,
+		const typename t_param_traits<FEAT>::listparam_type& config_listparam,
+		bool config_all_parameters
+	)
+	{
+		auto type = query_param.type();
+		bool explicit_query = type == t_batch_query_param::t_type::EXPLICIT;
+		bool config_query = type == t_batch_query_param::t_type::CONFIG;
+
+		// Key on only what the query type reads
+		typename t_cache<FEAT>::t_list_key key(
+			type,
+			explicit_query ? query_param.m_values : t_string_list(),
+			config_query ? config_listparam : typename t_param_traits<FEAT>::listparam_type(),
+			config_query && config_all_parameters
+		);
+		++m_requests;
+		auto& entry = cache<FEAT>().m_lists[key];
+		if (!entry)
+		{
+			entry = std::make_shared<const typename lists_ptr<FEAT>::element_type>(
+				get_list_parameters<FEAT>(query_param, config_listparam, config_all_parameters, m_sim));
+			++m_resolved;
+		}
+		return entry;
+	}
+
+	// Queries planned, and distinct parameter sets resolved for them
+	size_t requests() const			{ return m_requests; }
+	size_t resolved() const			{ return m_resolved; }
+
+private:
+
+	template<typename FEAT>
+	struct t_cache
+	{
+		using traits = t_param_traits<FEAT>;
+		using t_item_key = std::tuple<t_batch_query_param::t_type, t_string_list, typename traits::parameter_type>;
+		using t_list_key = std::tuple<t_batch_query_param::t_type, t_string_list, typename traits::listparam_type, bool>;
+
+		std::map<t_item_key, items_ptr<FEAT>>		m_items;
+		std::map<t_list_key, lists_ptr<FEAT>>		m_lists;
+	};
+
+	template<typename FEAT>
+	t_cache<FEAT>& cache()
+	{
+		static_assert(feature_list::template contains<FEAT>(), "Feature type not in planner feature list");
+		return std::get<feature_list::template index<FEAT>()>(m_caches);
+	}
+
+	const t_live_simulation&		m_sim;
+	std::tuple<t_cache<FEATS>...>	m_caches;
+	size_t							m_requests = 0;
+	size_t							m_resolved = 0;
+};
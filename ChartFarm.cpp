@@ -0,0 +1,47 @@
+// Sample code - David Wilson
+
+#include "Include1.h"
+#include "Include2.h"
+#include "Include3.h"
+
+#include "ChartFarm.h"
+
+
+// ------------------------------------------------------------------------
+// t_chart_farm
+// ------------------------------------------------------------------------
+
+size_t t_chart_farm::run(const std::vector<t_chart_job>& jobs, t_string_list* failed) const
+{
+	size_t written = 0;
+	m_executor.run(jobs, render,
+		[&written, failed](const t_chart_job& job, bool ok)
+		{
+			if (ok)
+				++written;
+			else if (failed)
+				failed->push_back(job.m_path);
+		});
+	return written;
+}
+
+bool t_chart_farm::vector_format(const t_string& path)
+{
+	auto dot = path.find_last_of(_T('.'));
+	if (dot == t_string::npos) return false;
+
+	t_string extension = path.substr(dot + 1);
+	for (auto& c : extension)
+		c = t_char(_totlower(c));
+	return extension == _T("svg") || extension == _T("pdf");
+}
+
+bool t_chart_farm::render(const t_chart_job& job)
+{
+	// Headless renders are never superseded, so always give a chart
+	auto chart = job.m_graph->render_headless(job.m_page_width, job.m_page_height, vector_format(job.m_path));
+	ASSERT(chart);
+
+	// ChartDirector picks format from file extension
+	return chart->makeChart(TCHARtoUTF8(job.m_path.c_str())) != 0;
+}
@@ -0,0 +1,58 @@
+// David Wilson - Code Sample
+
+#pragma once
+
+#include "Include1.h"
+#include "Include2.h"
+#include "Include3.h"
+
+#include "Batch.h"
+
+
+//----------------------------------------------------------------------
+// t_chart_job: One chart page to export
+//----------------------------------------------------------------------
+
+// Output format follows the path's extension: .png, .svg or .pdf.
+// SVG and PDF pages are rendered as vector graphics.
+
+struct t_chart_job
+{
+	t_rms_graph*					m_graph;
+	int								m_page_width;
+	int								m_page_height;
+	t_string						m_path;
+};
+
+
+//----------------------------------------------------------------------
+// t_chart_farm: Renders and writes chart pages on worker threads
+//----------------------------------------------------------------------
+
+// Pages are rendered headless, so graphs need no viewer. Each page is
+// written to disk by the worker that rendered it, and its chart freed
+// straight away, so memory use does not grow with the job count. Pages
+// of the same graph share its state lock only while taking a snapshot of
+// it, and leave its interactive view alone; pages of different graphs
+// render fully in parallel.
+
+class t_chart_farm
+{
+public:
+
+	// Zero threads means one per hardware thread
+	explicit t_chart_farm(unsigned threads = 0) :
+		m_executor(threads)
+	{ }
+
+	// Returns pages written; paths of pages not written go to failed
+	size_t run(const std::vector<t_chart_job>& jobs, t_string_list* failed = nullptr) const;
+
+	static bool vector_format(const t_string& path);
+
+private:
+
+	static bool render(const t_chart_job& job);
+
+	t_batch_executor				m_executor;
+};
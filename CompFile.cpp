@@ -0,0 +1,215 @@
+// Sample code - David Wilson
+
+#include "Include1.h"
+#include "Include2.h"
+#include "Include3.h"
+
+#include "CompFile.h"
+
+
+// ------------------------------------------------------------------------
+// t_comp_file_writer
+// ------------------------------------------------------------------------
+
+bool t_comp_file_writer::create(LPCTSTR path, uint32_t component_count, uint32_t chunk_samples, double time_step)
+{
+	// If layout is empty, choke
+	close();
+	if (component_count == 0 || chunk_samples == 0)
+		return false;
+
+	m_file = ::CreateFile(path, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (m_file == INVALID_HANDLE_VALUE)
+		return false;
+
+	m_header = {};
+	m_header.m_magic			= t_comp_file_header::MAGIC;
+	m_header.m_version			= t_comp_file_header::VERSION;
+	m_header.m_component_count	= component_count;
+	m_header.m_chunk_samples	= chunk_samples;
+	m_header.m_sample_count		= 0;
+	m_header.m_time_step		= time_step;
+
+	m_chunk.assign(size_t(m_header.chunk_bytes()/sizeof(double)), 0.0);
+	m_chunk_fill = 0;
+
+	// Reserve header; rewritten with final sample count on close
+	std::vector<char> header(size_t(t_comp_file_header::SIZE), 0);
+	return write(header.data(), header.size());
+}
+
+bool t_comp_file_writer::add_step(const double* samples)
+{
+	// If not open, choke
+	if (m_file == INVALID_HANDLE_VALUE)
+		return false;
+
+	// Scatter step into each component's column of current chunk
+	const auto chunk_samples = m_header.m_chunk_samples;
+	double* column = m_chunk.data() + m_chunk_fill;
+	for (uint32_t component = 0; component < m_header.m_component_count; ++component, column += chunk_samples)
+		*column = samples[component];
+
+	++m_header.m_sample_count;
+	if (++m_chunk_fill < chunk_samples)
+		return true;
+	return flush_chunk();
+}
+
+bool t_comp_file_writer::close()
+{
+	if (m_file == INVALID_HANDLE_VALUE)
+		return true;
+
+	// Write final partial chunk, then header
+	bool ok = m_chunk_fill == 0 || flush_chunk();
+	LARGE_INTEGER start = {};
+	ok = ok
+		&& ::SetFilePointerEx(m_file, start, nullptr, FILE_BEGIN)
+		&& write(&m_header, sizeof(m_header));
+
+	::CloseHandle(m_file);
+	m_file = INVALID_HANDLE_VALUE;
+	m_chunk.clear();
+	m_chunk.shrink_to_fit();
+	return ok;
+}
+
+bool t_comp_file_writer::write(const void* data, uint64_t bytes)
+{
+	auto bytes_left = bytes;
+	auto next = static_cast<const char*>(data);
+	while (bytes_left > 0)
+	{
+		DWORD block = DWORD(std::min<uint64_t>(bytes_left, 1 << 30));
+		DWORD written = 0;
+		if (!::WriteFile(m_file, next, block, &written, nullptr) || written == 0)
+			return false;
+		next += written;
+		bytes_left -= written;
+	}
+	return true;
+}
+
+bool t_comp_file_writer::flush_chunk()
+{
+	// Chunk is always written full size so chunk offsets stay uniform
+	bool ok = write(m_chunk.data(), m_header.chunk_bytes());
+	std::fill(m_chunk.begin(), m_chunk.end(), 0.0);
+	m_chunk_fill = 0;
+	return ok;
+}
+
+
+// ------------------------------------------------------------------------
+// t_comp_file
+// ------------------------------------------------------------------------
+
+bool t_comp_file::open(LPCTSTR path)
+{
+	close();
+	m_file = ::CreateFile(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+	if (m_file == INVALID_HANDLE_VALUE)
+		return false;
+
+	// Read and check header
+	DWORD read = 0;
+	if (!::ReadFile(m_file, &m_header, sizeof(m_header), &read, nullptr) || read != sizeof(m_header) || !m_header.valid())
+	{
+		close();
+		return false;
+	}
+
+	// If file shorter than header claims, choke
+	LARGE_INTEGER file_size = {};
+	::GetFileSizeEx(m_file, &file_size);
+	if (uint64_t(file_size.QuadPart) < t_comp_file_header::SIZE + m_header.chunk_count()*m_header.chunk_bytes())
+	{
+		close();
+		return false;
+	}
+
+	m_mapping = ::CreateFileMapping(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!m_mapping)
+	{
+		close();
+		return false;
+	}
+
+	SYSTEM_INFO system_info;
+	::GetSystemInfo(&system_info);
+	m_granularity = system_info.dwAllocationGranularity;
+	return true;
+}
+
+void t_comp_file::close()
+{
+	if (m_mapping)
+		::CloseHandle(m_mapping);
+	if (m_file != INVALID_HANDLE_VALUE)
+		::CloseHandle(m_file);
+	m_mapping = nullptr;
+	m_file = INVALID_HANDLE_VALUE;
+	m_header = {};
+}
+
+
+// ------------------------------------------------------------------------
+// t_comp_stream
+// ------------------------------------------------------------------------
+
+t_comp_stream::t_comp_stream(const t_comp_file& file, uint32_t component) :
+	m_file(file),
+	m_component(component)
+{
+	ASSERT(file.is_open() && component < file.component_count());
+}
+
+size_t t_comp_stream::read(double* samples, size_t count)
+{
+	// Copy whole runs of each mapped chunk column
+	size_t total = 0;
+	while (total < count && !done() && map_position(m_position))
+	{
+		auto run = std::min<uint64_t>({ count - total, m_chunk_end - m_position, m_file.m_header.m_sample_count - m_position });
+		std::copy_n(m_samples + (m_position - m_chunk_first), size_t(run), samples + total);
+		m_position += run;
+		total += size_t(run);
+	}
+	return total;
+}
+
+bool t_comp_stream::map_chunk(uint64_t chunk)
+{
+	unmap();
+
+	// Views must start on allocation granularity
+	const auto& header	= m_file.m_header;
+	auto offset			= header.column_offset(m_component, chunk);
+	auto view_offset	= offset - offset % m_file.m_granularity;
+	auto view_bytes		= offset - view_offset + header.column_bytes();
+
+	m_view = ::MapViewOfFile(m_file.m_mapping, FILE_MAP_READ,
+		DWORD(view_offset >> 32), DWORD(view_offset), SIZE_T(view_bytes));
+	// If view cannot be mapped, fail
+	if (!m_view)
+	{
+		m_failed = true;
+		return false;
+	}
+
+	m_samples		= reinterpret_cast<const double*>(static_cast<const char*>(m_view) + (offset - view_offset));
+	m_chunk_first	= chunk*header.m_chunk_samples;
+	m_chunk_end		= m_chunk_first + header.m_chunk_samples;
+	return true;
+}
+
+void t_comp_stream::unmap()
+{
+	if (m_view)
+		::UnmapViewOfFile(m_view);
+	m_view			= nullptr;
+	m_samples		= nullptr;
+	m_chunk_first	= 0;
+	m_chunk_end		= 0;
+}
@@ -0,0 +1,248 @@
+// David Wilson - Code Sample
+
+#pragma once
+
+#include "Include1.h"
+#include "Include2.h"
+#include "Include3.h"
+
+
+//----------------------------------------------------------------------
+// t_comp_file_header: Chunked columnar component buffer file
+//----------------------------------------------------------------------
+
+// Layout: header, padded to SIZE bytes, followed by chunks. Each chunk
+// holds chunk_samples time steps for every component, stored component
+// by component, so streaming one component touches one contiguous run
+// per chunk. The final chunk is padded to full size.
+
+struct t_comp_file_header
+{
+	static constexpr uint32_t MAGIC		= 0x42504d43;	// "CMPB"
+	static constexpr uint32_t VERSION	= 1;
+	static constexpr uint64_t SIZE		= 4096;
+
+	uint32_t	m_magic;
+	uint32_t	m_version;
+	uint32_t	m_component_count;
+	uint32_t	m_chunk_samples;
+	uint64_t	m_sample_count;
+	double		m_time_step;
+
+	bool valid() const
+	{ return m_magic == MAGIC && m_version == VERSION && m_chunk_samples > 0; }
+
+	uint64_t column_bytes() const
+	{ return uint64_t(m_chunk_samples)*sizeof(double); }
+
+	uint64_t chunk_bytes() const
+	{ return uint64_t(m_component_count)*column_bytes(); }
+
+	uint64_t chunk_count() const
+	{ return (m_sample_count + m_chunk_samples - 1)/m_chunk_samples; }
+
+	uint64_t column_offset(uint32_t component, uint64_t chunk) const
+	{ return SIZE + chunk*chunk_bytes() + component*column_bytes(); }
+};
+
+
+//----------------------------------------------------------------------
+// t_comp_file_writer: Writes component samples step by step
+//----------------------------------------------------------------------
+
+// Only the chunk being filled is held in memory. create() fails on an
+// empty layout, and add_step() fails unless create() succeeded.
+
+class t_comp_file_writer
+{
+public:
+
+	t_comp_file_writer() = default;
+	t_comp_file_writer(const t_comp_file_writer&) = delete;
+	t_comp_file_writer& operator=(const t_comp_file_writer&) = delete;
+	~t_comp_file_writer()		{ close(); }
+
+	bool create(LPCTSTR path, uint32_t component_count, uint32_t chunk_samples, double time_step);
+	bool add_step(const double* samples);
+	bool close();
+
+private:
+
+	bool write(const void* data, uint64_t bytes);
+	bool flush_chunk();
+
+	HANDLE						m_file = INVALID_HANDLE_VALUE;
+	t_comp_file_header			m_header = {};
+	std::vector<double>			m_chunk;
+	uint32_t					m_chunk_fill = 0;
+};
+
+
+//----------------------------------------------------------------------
+// t_comp_file: Read-only memory mapping of component buffer file
+//----------------------------------------------------------------------
+
+class t_comp_file
+{
+public:
+
+	t_comp_file() = default;
+	t_comp_file(const t_comp_file&) = delete;
+	t_comp_file& operator=(const t_comp_file&) = delete;
+	~t_comp_file()				{ close(); }
+
+	bool open(LPCTSTR path);
+	void close();
+
+	bool is_open() const						{ return m_mapping != nullptr; }
+	const t_comp_file_header& header() const	{ return m_header; }
+	size_t component_count() const				{ return m_header.m_component_count; }
+	size_t sample_count() const					{ return size_t(m_header.m_sample_count); }
+	double time_step() const					{ return m_header.m_time_step; }
+
+private:
+
+	friend class t_comp_stream;
+
+	HANDLE						m_file = INVALID_HANDLE_VALUE;
+	HANDLE						m_mapping = nullptr;
+	t_comp_file_header			m_header = {};
+	uint64_t					m_granularity = 0;
+};
+
+
+//----------------------------------------------------------------------
+// t_comp_stream: Sequential reader for one component
+//----------------------------------------------------------------------
+
+// At most one chunk column is mapped at a time, so resident memory per
+// stream is one column (plus mapping alignment) whatever the run length.
+// If a chunk cannot be mapped, reads stop short and failed() is set.
+
+class t_comp_stream
+{
+public:
+
+	t_comp_stream(const t_comp_file& file, uint32_t component);
+	t_comp_stream(const t_comp_stream&) = delete;
+	t_comp_stream& operator=(const t_comp_stream&) = delete;
+	~t_comp_stream()			{ unmap(); }
+
+	size_t position() const		{ return size_t(m_position); }
+	bool done() const			{ return m_position >= m_file.m_header.m_sample_count; }
+	bool failed() const			{ return m_failed; }
+	void seek(size_t position)	{ m_position = position; }
+
+	// Next sample; false if done or chunk cannot be mapped
+	bool next(double& sample)
+	{
+		if (!sample_at(m_position, sample))
+			return false;
+		++m_position;
+		return true;
+	}
+
+	// Sample at position, leaving stream position unchanged; false if
+	// past end or chunk cannot be mapped
+	bool sample_at(uint64_t position, double& sample)
+	{
+		if (position >= m_file.m_header.m_sample_count || !map_position(position))
+			return false;
+		sample = m_samples[position - m_chunk_first];
+		return true;
+	}
+
+	// Read up to count samples, returning number read
+	size_t read(double* samples, size_t count);
+
+private:
+
+	bool map_position(uint64_t position)
+	{
+		if (position >= m_chunk_first && position < m_chunk_end)
+			return true;
+		return map_chunk(position/m_file.m_header.m_chunk_samples);
+	}
+
+	bool map_chunk(uint64_t chunk);
+	void unmap();
+
+	const t_comp_file&			m_file;
+	uint32_t					m_component;
+	uint64_t					m_position = 0;
+	uint64_t					m_chunk_first = 0;
+	uint64_t					m_chunk_end = 0;
+	void*						m_view = nullptr;
+	const double*				m_samples = nullptr;
+	bool						m_failed = false;
+};
+
+
+//----------------------------------------------------------------------
+// t_comp_file_buffer: Component buffer over one file component
+//----------------------------------------------------------------------
+
+// Offers the read side of a component buffer, size(), time_step(),
+// indexing and iteration, so calculators can restart from a file
+// instead of an in-memory run. Reads stream through one mapped chunk
+// column, so sequential access maps each chunk once. A sample whose
+// chunk cannot be mapped reads as zero and sets failed().
+
+class t_comp_file_buffer
+{
+public:
+
+	class const_iterator
+	{
+	public:
+
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = double;
+		using difference_type = std::ptrdiff_t;
+		using pointer = void;
+		using reference = double;
+
+		const_iterator() = default;
+
+		const_iterator(const t_comp_file_buffer* buffer, size_t position) :
+			m_buffer(buffer),
+			m_position(position)
+		{ }
+
+		double operator*() const							{ return (*m_buffer)[m_position]; }
+		const_iterator& operator++()						{ ++m_position; return *this; }
+		const_iterator operator++(int)						{ return const_iterator(m_buffer, m_position++); }
+		bool operator==(const_iterator other) const			{ return m_position == other.m_position; }
+		bool operator!=(const_iterator other) const			{ return m_position != other.m_position; }
+
+	private:
+
+		const t_comp_file_buffer*	m_buffer = nullptr;
+		size_t						m_position = 0;
+	};
+
+	t_comp_file_buffer(const t_comp_file& file, uint32_t component) :
+		m_file(file),
+		m_stream(file, component)
+	{ }
+
+	size_t size() const						{ return m_file.sample_count(); }
+	bool empty() const						{ return size() == 0; }
+	double time_step() const				{ return m_file.time_step(); }
+	bool failed() const						{ return m_stream.failed(); }
+
+	double operator[](size_t position) const
+	{
+		double sample = 0;
+		m_stream.sample_at(position, sample);
+		return sample;
+	}
+
+	const_iterator begin() const			{ return const_iterator(this, 0); }
+	const_iterator end() const				{ return const_iterator(this, size()); }
+
+private:
+
+	const t_comp_file&			m_file;
+	mutable t_comp_stream		m_stream;
+};
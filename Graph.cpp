@@ -4,11 +4,31 @@
 #include "Include2.h"
 #include "Include3.h"
 
+#include <execution>
+#include <thread>
+
+#include "RmsCache.h"
+#include "RmsData.h"
+#include "RmsSummary.h"
+#include "SampleRing.h"
+#include "Trace.h"
+
 
 // ------------------------------------------------------------------------
 // t_rms_bar_base
 // ------------------------------------------------------------------------
 
+namespace
+{
+
+// Samples in run so far; every component's buffer has one per step
+uint64_t run_samples(const t_component_info_set& infos)
+{
+	return infos.size() == 0 ? 0 : uint64_t(infos.begin()->comp_buffer().size());
+}
+
+}
+
 t_rms_bar_base::t_rms_bar_base(const t_char* name, int color, bool use_right_axis) :
 	m_min_value(0),
 	m_max_value(0),
@@ -20,51 +40,272 @@ t_rms_bar_base::t_rms_bar_base(const t_char* name, int color, bool use_right_axi
 void t_rms_bar_base::clear_data()
 {
 	m_data.clear();
+	m_pyramid.clear();
+	m_min_value = 0;
+	m_max_value = 0;
+}
+
+void t_rms_bar_base::set_retention(t_column_history::t_retention retention, size_t columns)
+{
+	// Changing policy drops history kept under old one
+	m_data.set_retention(retention, columns);
+	m_pyramid.clear();
 	m_min_value = 0;
 	m_max_value = 0;
 }
 
-void t_rms_bar_base::add_datum(double datum)
+void t_rms_bar_base::add_data(const double* first, const double* last)
 {
-	m_data.push_back(datum);
-	at_most(m_min_value, datum);
-	at_least(m_max_value, datum);
+	// Add column to history, then take bounds over retained columns
+	m_data.add(first, last);
+	m_min_value = std::min(0.0, m_data.min());
+	m_max_value = std::max(0.0, m_data.max());
+}
+
+void t_rms_bar_base::commit_column()
+{
+	// Keep calculator values, in calculator units, with samples they
+	// cover for summaries; live columns are not whole-run values
+	if (m_column_samples != 0)
+	{
+		m_calculated.assign(m_column.begin(), m_column.end());
+		m_calculated_samples = m_column_samples;
+	}
+
+	// Convert gathered calculator values to user units, then add as one column
+	for (auto& value : m_column)
+		value = to_user(value);
+	add_data(m_column.data(), m_column.data() + m_column.size());
+
+	// Rebuild zoomed-out aggregates over latest column
+	m_pyramid.build(m_data.latest(), m_data.width());
 }
 
 void t_rms_bar_base::rebuild(const t_component_info_set& infos)
 {
+	TRACE_SCOPE("bar rebuild", "graph");
+
+	// Calculators are held in component order, so the position of a
+	// component in the info set indexes its calculator directly
+	m_calculators.clear();
+	m_calculators.reserve(infos.size());
+	m_deferred.clear();
+	m_deferred.reserve(infos.size());
+	m_column.clear();
+	m_column.reserve(infos.size());
+	m_deferred_infos.clear();
+	m_restarts_deferred = false;
+	auto samples = run_samples(infos);
+	m_column_samples = samples;
+
+	// Use saved summary only if it covers run so far and lists these
+	// components in this order
+	auto table = m_summary && m_summary->sample_count() == samples
+		? m_summary->find(quantity(), m_window, infos.time_step()) : nullptr;
+	if (table && table->m_ids.size() == infos.size())
+	{
+		size_t i = 0;
+		for (auto& info : infos)
+		{
+			if (table->m_ids[i++] != int64_t(info.component().id()))
+			{
+				table = nullptr;
+				break;
+			}
+		}
+	}
+	else
+		table = nullptr;
+
+	size_t component = 0;
 	for (auto& info : infos)
 	{
-		auto& calc = m_calculators.emplace(info.component().id(), calculator(infos.time_step())).first->second;
+		auto& calc = m_calculators.emplace_back(calculator(infos.time_step()));
 		calc->rebuild();
+
+		// If value saved at end of run or already computed, defer restart to first update
+		t_rms_cache_key key{ m_run, info.component().id(), quantity(), m_window, infos.time_step(), samples };
+		std::optional<double> value;
+		if (table)
+			value = table->m_values[component];
+		else if (m_cache)
+			value = m_cache->find(key);
+		++component;
+		if (value)
+		{
+			m_column.push_back(*value);
+			m_deferred.push_back(1);
+			if (table && m_cache)
+				m_cache->insert(key, *value);
+			continue;
+		}
+
 		calc->restart(info.comp_buffer());
-		add_datum(to_user(calc->initial_value()));
+		m_column.push_back(calc->initial_value());
+		m_deferred.push_back(0);
+		if (m_cache)
+			m_cache->insert(key, m_column.back());
 	}
+	auto deferred = size_t(std::count(m_deferred.begin(), m_deferred.end(), 1));
+	m_restarts_deferred = deferred > 0;
+	TRACE_COUNTER("calculators created", infos.size());
+	TRACE_COUNTER("buffers replayed", infos.size() - deferred);
+	commit_column();
 }
 
 void t_rms_bar_base::restart(const t_component_info_set& infos)
 {
+	ASSERT(m_calculators.size() == infos.size());
+	auto calc = m_calculators.begin();
 	for (auto& info : infos)
-		m_calculators[info.component().id()]->restart(info.comp_buffer());
+		(*calc++)->restart(info.comp_buffer());
+	m_deferred.assign(m_calculators.size(), 0);
+	m_deferred_infos.clear();
+	m_restarts_deferred = false;
 }
 
-void t_rms_bar_base::update(const t_component_info_set& infos)
+void t_rms_bar_base::set_cache(t_rms_cache* cache, uint64_t run)
+{
+	m_cache	= cache;
+	m_run	= run;
+}
+
+void t_rms_bar_base::set_window(double window)
+{
+	// RMS window of calculators in seconds, or 0 where they set it from
+	// time step. Keys cached results from next rebuild.
+	m_window = window;
+}
+
+void t_rms_bar_base::set_summary(const t_rms_summary* summary)
+{
+	m_summary = summary;
+}
+
+std::optional<t_rms_summary::t_table> t_rms_bar_base::summarize(const t_component_info_set& infos, uint64_t sample_count) const
 {
+	// Values are those of last rebuild or update; if not computed for
+	// these components over sample_count samples, none
+	if (m_calculated.size() != infos.size() || m_calculated_samples != sample_count)
+		return std::nullopt;
+
+	t_rms_summary::t_table table;
+	table.m_quantity	= quantity();
+	table.m_window		= m_window;
+	table.m_time_step	= infos.time_step();
+	table.m_values		= m_calculated;
+	table.m_ids.reserve(infos.size());
 	for (auto& info : infos)
+		table.m_ids.push_back(int64_t(info.component().id()));
+	return table;
+}
+
+void t_rms_bar_base::update(const t_component_info_set& infos)
+{
+	begin_update(infos);
+	update_range(0, m_calculators.size());
+	commit_column();
+}
+
+void t_rms_bar_base::begin_update(const t_component_info_set& infos)
+{
+	ASSERT(m_calculators.size() == infos.size());
+	m_column.resize(m_calculators.size());
+	m_column_samples = run_samples(infos);
+
+	// Note components of calculators whose initial values came from the
+	// cache; update_range restarts them, so the restarts share its threads
+	m_deferred_infos.clear();
+	if (m_restarts_deferred)
+	{
+		m_deferred_infos.assign(m_calculators.size(), nullptr);
+		size_t i = 0;
+		for (auto& info : infos)
+		{
+			if (m_deferred[i])
+				m_deferred_infos[i] = &info;
+			++i;
+		}
+		m_deferred.assign(m_calculators.size(), 0);
+		m_restarts_deferred = false;
+	}
+}
+
+void t_rms_bar_base::update_range(size_t lo, size_t hi)
+{
+	// Each component writes only its own column slot, so disjoint
+	// ranges of the same bar may be updated concurrently
+	for (auto i = lo; i < hi; ++i)
 	{
-		auto& calc = m_calculators[info.component().id()];
+		auto& calc = m_calculators[i];
+		if (!m_deferred_infos.empty() && m_deferred_infos[i])
+			calc->restart(m_deferred_infos[i]->comp_buffer());
 		calc->update();
-		add_datum(to_user(calc->has_value() ? calc->value() : 0.0));
+		m_column[i] = calc->has_value() ? calc->value() : 0.0;
 	}
 }
 
-void t_rms_bar_base::add_to_layer(BarLayer* layer, int vi_lo, int vi_hi) const
+void t_rms_bar_base::live_update(const t_live_channel& channel)
+{
+	// Only feeds of this bar's quantity
+	if (channel.quantity() != quantity()) return;
+
+	// Add live window RMS as next column
+	m_column_samples = 0;
+	m_column.resize(channel.width());
+	for (size_t i = 0; i < m_column.size(); ++i)
+		m_column[i] = channel.rms(i);
+	commit_column();
+}
+
+void t_rms_bar_base::add_to_layer(BarLayer* layer, int vi_lo, int vi_hi, int level) const
 {
-	DataSet* dataset = layer->addDataSet(DoubleArray(m_data.data() + vi_lo, vi_hi - vi_lo), color(), name());
+	// Plot latest column; if none yet, nothing to plot
+	if (m_data.empty()) return;
+
+	// If zoomed in, plot data directly
+	DataSet* dataset;
+	if (level == 0)
+		dataset = layer->addDataSet(DoubleArray(m_data.latest() + vi_lo, vi_hi - vi_lo), color(), name());
+
+	// Else plot one bar per bucket, keeping each bucket's peak. Edge
+	// buckets are cut to visible bars, so each bar covers only the
+	// components its label names.
+	else
+	{
+		auto first = size_t(vi_lo) >> level;
+		auto count = t_minmax_pyramid::bucket_count(level, vi_lo, vi_hi);
+		vector<double> peaks(count);
+		for (size_t bucket = 0; bucket < count; ++bucket)
+		{
+			auto lo = (first + bucket) << level;
+			auto hi = lo + (size_t(1) << level);
+			if (lo >= size_t(vi_lo) && hi <= size_t(vi_hi))
+				peaks[bucket] = m_pyramid.extreme(level, first + bucket);
+			else
+			{
+				auto bounds = m_pyramid.minmax(std::max(lo, size_t(vi_lo)), std::min(hi, size_t(vi_hi)));
+				peaks[bucket] = bounds.second >= -bounds.first ? bounds.second : bounds.first;
+			}
+		}
+		dataset = layer->addDataSet(DoubleArray(peaks.data(), int(count)), color(), name());
+	}
 	if (m_use_right_axis)
 		dataset->setUseYAxis2();
 }
 
+std::pair<double, double> t_rms_bar_base::visible_bounds(int vi_lo, int vi_hi) const
+{
+	// Latest column over visible bars, widened to include zero as for
+	// whole-history bounds. Edge buckets are cut to visible range when
+	// plotted, so exact range covers every plotted bar at any level.
+	auto hi = std::min<size_t>(vi_hi, m_pyramid.size());
+	if (vi_lo < 0 || hi <= size_t(vi_lo))
+		return { 0.0, 0.0 };
+	auto bounds = m_pyramid.minmax(vi_lo, hi);
+	return { std::min(bounds.first, 0.0), std::max(bounds.second, 0.0) };
+}
+
 void t_rms_bar_base::add_to_legend(t_legend& legend) const
 {
 	legend.add_key(name(), color());
@@ -75,9 +316,16 @@ void t_rms_bar_base::add_to_legend(t_legend& legend) const
 // t_component_bar_set
 // ------------------------------------------------------------------------
 
+// Components per parallel update task
+constexpr size_t PARALLEL_GRAIN		= 1024;
+
+// Bar-components below which updates stay on the calling thread
+constexpr size_t PARALLEL_MIN_WORK	= 4*PARALLEL_GRAIN;
+
 void t_component_bar_set::initialize(int units)
 {
 	m_bars.clear();
+	m_sources.clear();
 	m_left_min			= 0;
 	m_left_max			= 0;
 	m_right_min			= 0;
@@ -85,8 +333,15 @@ void t_component_bar_set::initialize(int units)
 	m_units				= units;
 	m_vi_lo				= 0;
 	m_vi_hi				= 0;
+	m_level				= 0;
 	m_use_left_axis		= false;
 	m_use_right_axis	= false;
+	m_parallel			= true;
+	m_fit_to_zoom		= false;
+	m_bounds_dirty		= true;
+	m_cache				= nullptr;
+	m_summary			= nullptr;
+	m_run				= 0;
 }
 
 void t_component_bar_set::clear_data()
@@ -95,20 +350,221 @@ void t_component_bar_set::clear_data()
 	m_right_min		= 0;
 	m_left_max		= 0;
 	m_right_max		= 0;
+	m_bounds_dirty	= true;
 	for (auto& bar : m_bars)
 		bar->clear_data();
 }
 
-void t_component_bar_set::set_zoom(const t_component_info_set& infos)
+bool t_component_bar_set::parallel(const t_component_info_set& infos) const
 {
-	m_vi_lo		= infos.vi_lo();
-	m_vi_hi		= infos.vi_hi();
+	return m_parallel && m_bars.size()*infos.size() >= PARALLEL_MIN_WORK;
+}
+
+template<typename FUNC>
+void t_component_bar_set::for_each_bar(const t_component_info_set& infos, FUNC func)
+{
+	// Pass each bar with its position, which indexes its run source
+	auto call = [this, &func](auto& bar) { func(bar, size_t(&bar - m_bars.data())); };
+	if (parallel(infos))
+		std::for_each(std::execution::par, m_bars.begin(), m_bars.end(), call);
+	else
+		std::for_each(m_bars.begin(), m_bars.end(), call);
+}
+
+const t_component_info_set& t_component_bar_set::bar_infos(size_t bar, const t_component_info_set& infos) const
+{
+	// Bars without comparison source show run passed in
+	return bar < m_sources.size() && m_sources[bar].m_infos ? *m_sources[bar].m_infos : infos;
+}
+
+uint64_t t_component_bar_set::bar_run(size_t bar) const
+{
+	return bar < m_sources.size() && m_sources[bar].m_infos ? m_sources[bar].m_run : m_run;
+}
+
+bool t_component_bar_set::same_components(const t_component_info_set& a, const t_component_info_set& b)
+{
+	return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+		[](const auto& info_a, const auto& info_b) { return info_a.component().id() == info_b.component().id(); });
+}
+
+void t_component_bar_set::add_comparison(std::unique_ptr<t_rms_bar_base> bar, const t_component_info_set& infos, uint64_t run)
+{
+	// Build compared run's calculators and initial column now, so it
+	// joins next update like any other bar
+	bar->set_cache(m_cache, run);
+	bar->set_summary(nullptr);
+	bar->rebuild(infos);
+
+	// Bars added before have no comparison source
+	m_sources.resize(m_bars.size());
+	m_sources.push_back({ &infos, run });
+	m_bars.push_back(std::move(bar));
+	m_bounds_dirty = true;
+}
+
+void t_component_bar_set::clear_comparisons()
+{
+	for (auto i = m_sources.size(); i-- > 0;)
+	{
+		if (m_sources[i].m_infos)
+			m_bars.erase(m_bars.begin() + i);
+	}
+	m_sources.clear();
+	m_bounds_dirty = true;
+}
+
+void t_component_bar_set::rebuild(const t_component_info_set& infos)
+{
+	m_bounds_dirty = true;
+
+	// Compared runs must list same components in same order as run
+	// shown; drop any that no longer do
+	for (auto i = m_sources.size(); i-- > 0;)
+	{
+		if (m_sources[i].m_infos && !same_components(*m_sources[i].m_infos, infos))
+		{
+			m_bars.erase(m_bars.begin() + i);
+			m_sources.erase(m_sources.begin() + i);
+		}
+	}
+
+	for_each_bar(infos, [this, &infos](auto& bar, size_t i)
+	{
+		const auto& run_infos = bar_infos(i, infos);
+		bar->set_cache(m_cache, bar_run(i));
+		bar->set_summary(&run_infos == &infos ? m_summary : nullptr);
+		bar->rebuild(run_infos);
+	});
+}
+
+void t_component_bar_set::restart(const t_component_info_set& infos)
+{
+	for_each_bar(infos, [this, &infos](auto& bar, size_t i) { bar->restart(bar_infos(i, infos)); });
+}
+
+void t_component_bar_set::update(const t_component_info_set& infos)
+{
+	TRACE_SCOPE("calculator update", "graph");
+	TRACE_COUNTER("components updated", m_bars.size()*infos.size());
+
+	m_bounds_dirty = true;
+	if (!parallel(infos))
+	{
+		for (size_t i = 0; i < m_bars.size(); ++i)
+			m_bars[i]->update(bar_infos(i, infos));
+		return;
+	}
+
+	// Split every bar, of every compared run, into component ranges and
+	// run all ranges as one task set, so a few large bars still spread
+	// across all cores
+	struct t_range
+	{
+		t_rms_bar_base*	bar;
+		size_t			lo;
+		size_t			hi;
+	};
+	vector<t_range> ranges;
+	for (size_t i = 0; i < m_bars.size(); ++i)
+	{
+		auto& bar = m_bars[i];
+		const auto& run_infos = bar_infos(i, infos);
+		bar->begin_update(run_infos);
+		for (size_t lo = 0; lo < run_infos.size(); lo += PARALLEL_GRAIN)
+			ranges.push_back({ bar.get(), lo, std::min(lo + PARALLEL_GRAIN, run_infos.size()) });
+	}
+	std::for_each(std::execution::par, ranges.begin(), ranges.end(),
+		[](const t_range& range) { range.bar->update_range(range.lo, range.hi); });
+
+	// Fold each bar's column into its own bounds. Bars are independent
+	// and each folds its column in order, so bounds do not depend on
+	// how ranges were scheduled, and update_axis_bounds merges bars in
+	// bar order as before.
+	std::for_each(std::execution::par, m_bars.begin(), m_bars.end(),
+		[](auto& bar) { bar->commit_column(); });
+}
+
+void t_component_bar_set::live_update(const t_live_channel& channel)
+{
+	// Live steps come from run shown, not compared runs
+	m_bounds_dirty = true;
+	for (size_t i = 0; i < m_bars.size(); ++i)
+	{
+		if (i >= m_sources.size() || !m_sources[i].m_infos)
+			m_bars[i]->live_update(channel);
+	}
+}
+
+void t_component_bar_set::set_retention(t_column_history::t_retention retention, size_t columns)
+{
+	m_bounds_dirty = true;
+	for (auto& bar : m_bars)
+		bar->set_retention(retention, columns);
+}
+
+void t_component_bar_set::set_cache(t_rms_cache* cache, uint64_t run)
+{
+	m_cache	= cache;
+	m_run	= run;
+}
+
+void t_component_bar_set::set_summary(const t_rms_summary* summary)
+{
+	m_summary = summary;
+}
+
+bool t_component_bar_set::summarize(const t_component_info_set& infos, t_rms_summary& summary)
+{
+	// Bars of run shown only, in bar order; if any bar's values do not
+	// cover summary's samples, none
+	for (size_t i = 0; i < m_bars.size(); ++i)
+	{
+		if (&bar_infos(i, infos) != &infos)
+			continue;
+		auto table = m_bars[i]->summarize(infos, summary.sample_count());
+		if (!table)
+			return false;
+		summary.add(std::move(*table));
+	}
+	return true;
+}
+
+void t_component_bar_set::set_fit_to_zoom(bool fit_to_zoom)
+{
+	m_fit_to_zoom	= fit_to_zoom;
+	m_bounds_dirty	= true;
+}
+
+void t_component_bar_set::set_zoom(const t_component_info_set& infos, int max_bars)
+{
+	// If fitting axes to visible bars, zoom, scroll or a new bar level
+	// (as on resize) changes what is plotted, so refit
+	auto vi_lo	= infos.vi_lo();
+	auto vi_hi	= infos.vi_hi();
+	auto level	= int(t_minmax_pyramid::level_for(vi_lo, vi_hi, max_bars));
+	if (m_fit_to_zoom && (m_vi_lo != vi_lo || m_vi_hi != vi_hi || m_level != level))
+		m_bounds_dirty = true;
+
+	m_vi_lo		= vi_lo;
+	m_vi_hi		= vi_hi;
+	m_level		= level;
+}
+
+int t_component_bar_set::bar_count() const
+{
+	return int(t_minmax_pyramid::bucket_count(m_level, m_vi_lo, m_vi_hi));
 }
 
 void t_component_bar_set::add_to_layer(BarLayer* layer)
+{
+	add_to_layer(layer, m_vi_lo, m_vi_hi, m_level);
+}
+
+void t_component_bar_set::add_to_layer(BarLayer* layer, int vi_lo, int vi_hi, int level) const
 {
 	for (auto& bar : m_bars)
-		bar.get()->add_to_layer(layer, m_vi_lo, m_vi_hi);
+		bar.get()->add_to_layer(layer, vi_lo, vi_hi, level);
 }
 
 void t_component_bar_set::add_to_legend(t_legend & legend)
@@ -119,44 +575,61 @@ void t_component_bar_set::add_to_legend(t_legend & legend)
 
 void t_component_bar_set::update_axis_bounds()
 {
-	m_left_min	= 0;
-	m_left_max	= 0;
-	m_right_min	= 0;
-	m_right_max	= 0;
+	// If no bar data changed since last call, bounds still hold
+	if (!m_bounds_dirty) return;
+	m_bounds_dirty = false;
+
+	auto bounds = axis_bounds(m_vi_lo, m_vi_hi);
+	m_left_min	= bounds.m_left_min;
+	m_left_max	= bounds.m_left_max;
+	m_right_min	= bounds.m_right_min;
+	m_right_max	= bounds.m_right_max;
+}
+
+t_axis_bounds t_component_bar_set::axis_bounds(int vi_lo, int vi_hi) const
+{
+	TRACE_SCOPE("axis bounds", "graph");
+
+	t_axis_bounds axes = { 0, 0, 0, 0 };
 	bool use_left_axis	= false;
 	bool use_right_axis	= false;
 	for (const auto& bar : m_bars)
 	{
+		// Visible bars only if fitting to zoom, else whole history
+		auto bounds = m_fit_to_zoom
+			? bar->visible_bounds(vi_lo, vi_hi)
+			: std::make_pair(bar->min_value(), bar->max_value());
+
 		if (bar->use_right_axis())
 		{
-			at_most(m_right_min, bar->min_value());
-			at_least(m_right_max, bar->max_value());
+			at_most(axes.m_right_min, bounds.first);
+			at_least(axes.m_right_max, bounds.second);
 			use_right_axis = true;
 		}
 		else
 		{
-			at_most(m_left_min, bar->min_value());
-			at_least(m_left_max, bar->max_value());
+			at_most(axes.m_left_min, bounds.first);
+			at_least(axes.m_left_max, bounds.second);
 			use_left_axis = true;
 		}
 	}
-	auto axis_min	= std::min(m_left_min, m_right_min);
-	auto axis_max	= std::max(m_left_max, m_right_max);
+	auto axis_min	= std::min(axes.m_left_min, axes.m_right_min);
+	auto axis_max	= std::max(axes.m_left_max, axes.m_right_max);
 
 	// If bars all positive, extend axes upward to minimum range
 	constexpr double min_range = 1;
 	if (axis_min == 0)
 	{
-		at_least(m_left_max, m_left_min + min_range);
-		at_least(m_right_max, m_right_min + min_range);		
+		at_least(axes.m_left_max, axes.m_left_min + min_range);
+		at_least(axes.m_right_max, axes.m_right_min + min_range);		
 	}
 
 	// Else if bars all negative, extend axes downward to minimum range
 	else if (axis_max == 0)
 	{
 		// Extend axes downward to minimum range
-		at_most(m_left_min, m_left_max - min_range);
-		at_most(m_right_min, m_right_max - min_range);
+		at_most(axes.m_left_min, axes.m_left_max - min_range);
+		at_most(axes.m_right_min, axes.m_right_max - min_range);
 	}
 
 	// Else bars both positive and negative
@@ -164,39 +637,40 @@ void t_component_bar_set::update_axis_bounds()
 	{
 		// Extend left and right axes minimally so zero aligns
 		auto scale = axis_max/axis_min;
-		if (m_left_max <= m_left_min*scale)
-			m_left_max = m_left_min*scale;
+		if (axes.m_left_max <= axes.m_left_min*scale)
+			axes.m_left_max = axes.m_left_min*scale;
 		else
-			m_left_min = m_left_max/scale;
-		if (m_right_max <= m_right_min*scale)
-			m_right_max = m_right_min*scale;
+			axes.m_left_min = axes.m_left_max/scale;
+		if (axes.m_right_max <= axes.m_right_min*scale)
+			axes.m_right_max = axes.m_right_min*scale;
 		else
-			m_right_min = m_right_max/scale;
+			axes.m_right_min = axes.m_right_max/scale;
 
 		// Extend left axis outward to minimum range
-		if (auto left_range = m_left_max - m_left_min; left_range == 0)
+		if (auto left_range = axes.m_left_max - axes.m_left_min; left_range == 0)
 		{
-			m_left_min	= -0.5*min_range;
-			m_right_min	=  0.5*min_range;
+			axes.m_left_min	= -0.5*min_range;
+			axes.m_right_min	=  0.5*min_range;
 		}
 		else if (left_range < min_range)
 		{
-			m_left_min	*= min_range/left_range;
-			m_left_max	*= min_range/left_range;
+			axes.m_left_min	*= min_range/left_range;
+			axes.m_left_max	*= min_range/left_range;
 		}
 
 		// Extend right axis outward to minimum range
-		if (auto right_range = m_right_max - m_right_min; right_range == 0)
+		if (auto right_range = axes.m_right_max - axes.m_right_min; right_range == 0)
 		{
-			m_right_min	= -0.5*min_range;
-			m_right_min	=  0.5*min_range;
+			axes.m_right_min	= -0.5*min_range;
+			axes.m_right_min	=  0.5*min_range;
 		}
 		else if (right_range < min_range)
 		{
-			m_right_min	*= min_range/right_range;
-			m_right_max	*= min_range/right_range;
+			axes.m_right_min	*= min_range/right_range;
+			axes.m_right_max	*= min_range/right_range;
 		}
 	}
+	return axes;
 }
 
 
@@ -204,19 +678,331 @@ void t_component_bar_set::update_axis_bounds()
 // t_rms_graph
 // ------------------------------------------------------------------------
 
+// Live steps buffered per graph before the simulation starts dropping them
+constexpr size_t LIVE_RING_STEPS = 4096;
+
+namespace
+{
+
+// Hash of component names, to see renames without converting labels
+size_t component_names_hash(const t_component_info_set& infos)
+{
+	size_t hash = infos.size();
+	for (auto& info : infos)
+		hash = hash*31 + std::hash<t_string>()(info.component_name_cd());
+	return hash;
+}
+
+// Draw icons onto transparent area, centred at bar pitch, with a margin
+// letting edge icons overhang plot area; returns margin
+int draw_icons(DrawArea& area, const vector<const DrawArea*>& icons, double xinc)
+{
+	int icon_width = 0;
+	int icon_height = 0;
+	for (auto icon : icons)
+	{
+		at_least(icon_width, icon->getWidth());
+		at_least(icon_height, icon->getHeight());
+	}
+	int margin = (icon_width + 1)/2;
+
+	area.setSize(round<int>(xinc*icons.size()) + 2*margin, icon_height, Chart::Transparent);
+	double x = margin + 0.5 * xinc;
+	for (auto icon : icons)
+	{
+		area.merge(icon, round<int>(x), 0, Chart::TopCenter, 0);
+		x += xinc;
+	}
+	return margin;
+}
+
+}
+
 t_rms_graph::t_rms_graph(const t_simulation& project, const t_live_simulation& simulation) :
 	inherited(project, simulation),
-	m_component(nullptr)
+	m_component(nullptr),
+	m_dirty(DIRTY_ALL)
 {
 	//m_plot_color_manager.rebuild();
 	m_plot_color_manager.set_plot_color(m_plot_color_left,	COLOR_CURRENT);
 	m_plot_color_manager.set_plot_color(m_plot_color_right,	COLOR_CURRENT);
 }
 
+t_rms_graph::~t_rms_graph()
+{
+	// Stop background renderer, abandoning any frame in progress
+	{
+		std::lock_guard<std::mutex> lock(m_render_mutex);
+		m_render_stop = true;
+		++m_render_generation;
+	}
+	m_render_wake.notify_one();
+	if (m_render_thread.joinable())
+		m_render_thread.join();
+
+	unsubscribe_live();
+}
+
+bool t_rms_graph::subscribe_live(t_sample_feed& feed, double window, double max_window)
+{
+	std::lock_guard<std::mutex> lock(m_state_mutex);
+
+	// Replace any channel from same feed
+	m_live_channels.erase(
+		std::remove_if(m_live_channels.begin(), m_live_channels.end(),
+			[&feed](const auto& channel) { return &channel->feed() == &feed; }),
+		m_live_channels.end());
+
+	// If feed lacks any graph component, refuse it
+	vector<t_id> component_ids;
+	component_ids.reserve(m_component_info_set.size());
+	for (auto& info : m_component_info_set)
+		component_ids.push_back(info.component().id());
+	// Any window up to max_window can later be shown at once
+	auto time_step = m_component_info_set.time_step();
+	auto window_samples = size_t(window/time_step + 0.5);
+	auto max_window_samples = size_t(std::max(window, max_window)/time_step + 0.5);
+	auto channel = t_live_channel::subscribe(feed, component_ids, window_samples, max_window_samples, LIVE_RING_STEPS);
+	if (!channel) return false;
+
+	m_live_channels.push_back(std::move(channel));
+	return true;
+}
+
+void t_rms_graph::set_live_window(double window)
+{
+	// Call from thread that subscribed. Windows past longest subscribed
+	// for are cut to it.
+	std::lock_guard<std::mutex> lock(m_state_mutex);
+	auto window_samples = size_t(window/m_component_info_set.time_step() + 0.5);
+	for (auto& channel : m_live_channels)
+		channel->set_window(window_samples);
+}
+
+void t_rms_graph::unsubscribe_live()
+{
+	std::lock_guard<std::mutex> lock(m_state_mutex);
+	m_live_channels.clear();
+}
+
+bool t_rms_graph::poll_live()
+{
+	// Call from thread that subscribed, which alone changes channel
+	// list, so steps are folded without holding state lock
+	vector<t_live_channel*> drained;
+	for (auto& channel : m_live_channels)
+	{
+		if (channel->drain())
+			drained.push_back(channel.get());
+	}
+	if (drained.empty()) return false;
+
+	// One column per poll and quantity, however many steps it covered.
+	// If components changed since subscribing, wait for resubscribe.
+	std::lock_guard<std::mutex> lock(m_state_mutex);
+	bool updated = false;
+	for (auto channel : drained)
+	{
+		const auto& ids = channel->component_ids();
+		if (!std::equal(ids.begin(), ids.end(), m_component_info_set.begin(), m_component_info_set.end(),
+				[](t_id id, const auto& info) { return id == info.component().id(); }))
+			continue;
+		m_component_bar_set.live_update(*channel);
+		updated = true;
+	}
+	return updated;
+}
+
+void t_rms_graph::set_run(uint64_t run)
+{
+	// Share RMS results with other graphs and batch reports on same run
+	std::lock_guard<std::mutex> lock(m_state_mutex);
+	m_component_bar_set.set_cache(&t_rms_cache::shared(), run);
+}
+
+bool t_rms_graph::add_comparison_run(std::unique_ptr<t_rms_bar_base> bar, const t_component_info_set& infos, uint64_t run)
+{
+	// Compared run adds a bar series over same components and labels;
+	// legend grows, so lay out again
+	std::lock_guard<std::mutex> lock(m_state_mutex);
+
+	// If run does not list same components in same order, refuse it
+	if (!t_component_bar_set::same_components(infos, m_component_info_set))
+		return false;
+
+	m_component_bar_set.add_comparison(std::move(bar), infos, run);
+	m_dirty |= DIRTY_LAYOUT | DIRTY_LEGEND;
+	return true;
+}
+
+void t_rms_graph::clear_comparison_runs()
+{
+	std::lock_guard<std::mutex> lock(m_state_mutex);
+	m_component_bar_set.clear_comparisons();
+	m_dirty |= DIRTY_LAYOUT | DIRTY_LEGEND;
+}
+
+bool t_rms_graph::save_summary(LPCTSTR path, uint64_t run, uint64_t sample_count)
+{
+	// Values are copied from bars; no buffers are replayed. If bars were
+	// not last rebuilt or updated over sample_count samples, choke.
+	t_rms_summary summary(run, sample_count);
+	{
+		std::lock_guard<std::mutex> lock(m_state_mutex);
+		if (!m_component_bar_set.summarize(m_component_info_set, summary))
+			return false;
+	}
+	return summary.save(path);
+}
+
+bool t_rms_graph::load_summary(LPCTSTR path, uint64_t run, uint64_t sample_count)
+{
+	// If summary missing, unreadable or from another run, rebuild replays buffers
+	auto summary = std::make_shared<t_rms_summary>();
+	bool valid = summary->load(path)
+		&& summary->run() == run
+		&& summary->sample_count() == sample_count;
+
+	std::lock_guard<std::mutex> lock(m_state_mutex);
+	m_summary = valid ? summary : nullptr;
+	m_component_bar_set.set_summary(m_summary.get());
+	return valid;
+}
+
+t_layout t_rms_graph::lay_out(const t_layout_key& key, t_legend* legend)
+{
+	// Fits header and legend above chart. Legend is graph's own, cached
+	// with layout, unless one is given, as for headless renders.
+	TRACE_SCOPE("layout", "graph");
+	int page_width			= key.m_page_width;
+	int page_height			= key.m_page_height;
+	int left_axis_width		= PAGE_MARGIN_LEFT + LEFT_AXIS_WIDTH;
+	int right_axis_width	= PAGE_MARGIN_RIGHT + RIGHT_AXIS_WIDTH;
+	int plot_width			= page_width - left_axis_width - right_axis_width;
+	int header_height;
+	int legend_top, legend_height;
+	int chart_top, chart_height;
+
+	bool show_header		= key.m_show_header;
+	bool show_legend		= key.m_show_legend;
+
+	for (;;)
+	{
+		at_least(plot_width, CHART_WIDTH_MIN);
+
+		header_height = PAGE_MARGIN_TOP + (show_header ? m_header.height(page_width) + t_legend::MARGIN_TOP : 0);
+
+		legend_top = header_height;
+		legend_height = 0;
+		if (show_legend)
+		{
+			if (legend)
+			{
+				legend->initialize(left_axis_width, legend_top, plot_width);
+				m_component_bar_set.add_to_legend(*legend);
+			}
+			else
+				init_legend(left_axis_width, legend_top, plot_width);
+			legend_height = (legend ? *legend : m_legend).height() + t_legend::MARGIN_BOTTOM;
+		}
+
+		chart_top = legend_top + legend_height;
+		int name_axis_height = key.m_max_name_width + NAME_AXIS_WIDTH;
+		chart_height = page_height - chart_top - name_axis_height - PAGE_MARGIN_BOTTOM;
+
+		if (chart_height >= CHART_HEIGHT_MIN) break;
+		if (show_header)				show_header = false;
+		else if (show_legend)			show_legend = false;
+		else {
+			at_least(chart_height, CHART_HEIGHT_MIN);
+			break;
+		}
+	}
+
+	// Legend was last initialized for this layout, so it is cached with it
+	t_layout layout;
+	layout.m_key				= key;
+	layout.m_left_axis_width	= left_axis_width;
+	layout.m_plot_width			= plot_width;
+	layout.m_chart_top			= chart_top;
+	layout.m_chart_height		= chart_height;
+	layout.m_show_header		= show_header;
+	layout.m_show_legend		= show_legend;
+	return layout;
+}
+
+void t_rms_graph::update_labels()
+{
+	// Convert and measure all component names once; repaints only slice them.
+	// Names are drawn rotated, so text width sets name axis height.
+	convert_labels(m_labels, 0, int(m_component_info_set.size()));
+	m_max_name_width = m_labels.max_width();
+	++m_label_generation;
+}
+
+void t_rms_graph::convert_labels(t_label_table& labels, int lo, int hi) const
+{
+	TRACE_SCOPE("labels", "graph");
+	DrawArea area;
+	labels.clear();
+	labels.reserve(std::max(hi - lo, 0));
+	int index = 0;
+	for (auto& info : m_component_info_set)
+	{
+		if (index >= hi) break;
+		if (index++ < lo) continue;
+		TCHARtoUTF8 label(info.component_name_cd().c_str());
+		TTFText* text = area.text(LPCSTR(label), s_axis_label_font.file(), s_axis_label_font.size());
+		labels.add(LPCSTR(label), text->getWidth());
+		text->destroy();
+	}
+	labels.seal();
+}
+
+bool t_rms_graph::icon_atlas_covers(const t_icon_key& key, int vi_lo, int vi_hi) const
+{
+	// Same bar pitch and components, and view inside atlas
+	return m_icon_atlas && key == m_icon_key
+		&& m_icon_atlas_lo <= vi_lo && vi_hi <= m_icon_atlas_hi;
+}
+
+void t_rms_graph::build_icon_atlas(const t_icon_key& key, int lo, const vector<const DrawArea*>& icons)
+{
+	TRACE_SCOPE("icon atlas", "graph");
+
+	// Compose icons on atlas at bar pitch of view
+	double xinc	= key.m_plot_width/double(key.m_visible_count);
+	m_icon_atlas = std::make_unique<DrawArea>();
+	m_icon_strip_margin = draw_icons(*m_icon_atlas, icons, xinc);
+
+	m_icon_key		= key;
+	m_icon_atlas_lo	= lo;
+	m_icon_atlas_hi	= lo + int(icons.size());
+}
+
+const DrawArea& t_rms_graph::icon_strip(int vi_lo)
+{
+	// Cut strip spanning plot width from atlas with one merge at an offset
+	double xinc	= m_icon_key.m_plot_width/double(m_icon_key.m_visible_count);
+	int offset	= round<int>((vi_lo - m_icon_atlas_lo)*xinc);
+	if (!m_icon_strip)
+		m_icon_strip = std::make_unique<DrawArea>();
+	m_icon_strip->setSize(m_icon_key.m_plot_width + 2*m_icon_strip_margin, m_icon_atlas->getHeight(), Chart::Transparent);
+	m_icon_strip->merge(m_icon_atlas.get(), -offset, 0, Chart::TopLeft, 0);
+	return *m_icon_strip;
+}
+
 void t_rms_graph::init_legend(int left, int top, int width)
 {
+	// If same bars in same place, legend still holds
+	CRect bounds(left, top, left + width, top);
+	if (!(m_dirty & DIRTY_LEGEND) && bounds == m_legend_bounds)
+		return;
+
 	m_legend.initialize(left, top, width);
 	m_component_bar_set.add_to_legend(m_legend);
+	m_legend_bounds = bounds;
+	m_dirty &= ~DIRTY_LEGEND;
 }
 
 void t_rms_graph::display_tool_tips(BaseChart * chart)
@@ -243,6 +1029,7 @@ bool t_rms_graph::zoom_at(int zoomDirection, int x, int y, double zoomRatio)
 	if (zoomDirection == Chart::DirectionVertical) return false;
 
 	// Get plot area dimensions
+	std::lock_guard<std::mutex> lock(m_state_mutex);
 	int left	= m_plot_bounds.left;
 	int width	= m_plot_bounds.Width();
 
@@ -256,6 +1043,7 @@ bool t_rms_graph::zoom_to(int zoomDirection, int x1, int y1, int x2, int y2)
 	if (zoomDirection == Chart::DirectionVertical) return false;
 
 	// Get plot area dimensions
+	std::lock_guard<std::mutex> lock(m_state_mutex);
 	int left	= m_plot_bounds.left;
 	int width	= m_plot_bounds.Width();
 
@@ -277,58 +1065,166 @@ bool t_rms_graph::zoom_to(int zoomDirection, int x1, int y1, int x2, int y2)
 
 void t_rms_graph::start_drag(int x, int y)
 {
+	std::lock_guard<std::mutex> lock(m_state_mutex);
 	m_component_info_set.start_drag((x - m_plot_bounds.left)/double(m_plot_bounds.Width()));
 }
 
 bool t_rms_graph::drag_to(int scrollDirection, int deltaX, int deltaY)
 {
+	std::lock_guard<std::mutex> lock(m_state_mutex);
 	m_component_info_set.drag_to(deltaX/double(m_plot_bounds.Width()));
 	return true;
 }
 
 t_chart_ptr t_rms_graph::get_chart(int page_width, int page_height, bool vector_graphics)
 {
-	// Lay out chart features
-	int left_axis_width		= PAGE_MARGIN_LEFT + LEFT_AXIS_WIDTH;
-	int right_axis_width	= PAGE_MARGIN_RIGHT + RIGHT_AXIS_WIDTH;
-	int plot_width			= page_width - left_axis_width - right_axis_width;
-	int header_height;
-	int legend_top, legend_height;
-	int chart_top, chart_height;
+	// Render synchronously; generation 0 is never superseded
+	t_render_request request = {
+		page_width, page_height, vector_graphics,
+		chartviewer().getViewPortTop(), chartviewer().getViewPortHeight(),
+		0,
+		false
+	};
+	return render_chart(request);
+}
+
+t_chart_ptr t_rms_graph::render_headless(int page_width, int page_height, bool vector_graphics)
+{
+	// Whole graph at current zoom, independent of any viewer and of the
+	// interactive caches and zoom state
+	t_render_request request = {
+		page_width, page_height, vector_graphics,
+		0.0, 1.0,
+		0,
+		true
+	};
+	return render_chart(request);
+}
 
-	bool show_header		= m_show_header;
-	bool show_legend		= m_show_legend;
+void t_rms_graph::request_chart(int page_width, int page_height, bool vector_graphics)
+{
+	// Replace any pending request; superseded renders notice and stop
+	std::lock_guard<std::mutex> lock(m_render_mutex);
+	m_render_request = {
+		page_width, page_height, vector_graphics,
+		chartviewer().getViewPortTop(), chartviewer().getViewPortHeight(),
+		++m_render_generation,
+		false
+	};
+	m_render_pending = true;
+	if (!m_render_thread.joinable())
+		m_render_thread = std::thread(&t_rms_graph::render_loop, this);
+	m_render_wake.notify_one();
+}
+
+t_chart_ptr t_rms_graph::latest_chart() const
+{
+	std::lock_guard<std::mutex> lock(m_render_mutex);
+	return m_render_latest;
+}
 
+void t_rms_graph::render_loop()
+{
+	std::unique_lock<std::mutex> lock(m_render_mutex);
 	for (;;)
 	{
-		at_least(plot_width, CHART_WIDTH_MIN);
+		// Wait for request, taking only the latest
+		m_render_wake.wait(lock, [this] { return m_render_pending || m_render_stop; });
+		if (m_render_stop) return;
+		auto request = m_render_request;
+		m_render_pending = false;
+
+		// Render without holding request lock
+		lock.unlock();
+		auto chart = render_chart(request);
+		lock.lock();
+
+		// If frame still current, publish it
+		if (chart && !superseded(request))
+		{
+			m_render_latest = chart;
+			if (m_render_ready)
+			{
+				lock.unlock();
+				m_render_ready();
+				lock.lock();
+			}
+		}
+	}
+}
 
-		header_height = PAGE_MARGIN_TOP + (show_header ? m_header.height(page_width) + t_legend::MARGIN_TOP : 0);
+bool t_rms_graph::superseded(const t_render_request& request) const
+{
+	// Generation is atomic, as renders check it without request lock
+	return request.m_generation != 0 && request.m_generation != m_render_generation.load();
+}
 
-		legend_top = header_height;
-		legend_height = 0;
-		if (show_legend)
+t_chart_ptr t_rms_graph::render_chart(const t_render_request& request)
+{
+	TRACE_SCOPE("render chart", "graph");
+
+	int page_width			= request.m_page_width;
+	int page_height			= request.m_page_height;
+	bool vector_graphics	= request.m_vector_graphics;
+
+	// Graph state is read under lock until chart data is set up.
+	// Chart layout, drawing and icons then run unlocked.
+	std::unique_lock<std::mutex> lock(m_state_mutex);
+
+	// Interactive renders use and refresh the graph's cached labels,
+	// layout, legend, zoom and axis bounds. Headless renders build their
+	// own from a snapshot of the components and bars at current zoom, so
+	// they leave interactive state alone.
+	bool headless			= request.m_headless;
+	int vi_lo				= m_component_info_set.vi_lo();
+	int vi_hi				= m_component_info_set.vi_hi();
+	t_label_table headless_labels;
+	t_legend headless_legend;
+	const char* const* labels;		// From vi_lo
+	int max_name_width;
+	t_layout layout;
+	if (!headless)
+	{
+		// Convert and measure labels, unless component names unchanged.
+		// Components may be renamed in place, so compare names, not count.
+		auto names_hash = component_names_hash(m_component_info_set);
+		if ((m_dirty & DIRTY_LABELS) || m_labels.size() != m_component_info_set.size() || names_hash != m_label_names_hash)
 		{
-			init_legend(left_axis_width, legend_top, plot_width);
-			legend_height = m_legend.height() + t_legend::MARGIN_BOTTOM;
+			update_labels();
+			m_label_names_hash = names_hash;
+			m_dirty &= ~DIRTY_LABELS;
 		}
 
-		chart_top = legend_top + legend_height;
-		int name_axis_height = m_max_name_width + NAME_AXIS_WIDTH;
-		chart_height = page_height - chart_top - name_axis_height - PAGE_MARGIN_BOTTOM;
-
-		if (chart_height >= CHART_HEIGHT_MIN) break;
-		if (show_header)				show_header = false;
-		else if (show_legend)			show_legend = false;
-		else {
-			at_least(chart_height, CHART_HEIGHT_MIN);
-			break;
+		// Lay out chart features, unless nothing affecting layout changed
+		t_layout_key key = { page_width, page_height, m_show_header, m_show_legend, m_max_name_width };
+		if ((m_dirty & (DIRTY_LAYOUT | DIRTY_LEGEND)) || !(key == m_layout.m_key))
+		{
+			m_layout = lay_out(key, nullptr);
+			m_dirty &= ~DIRTY_LAYOUT;
 		}
+		labels			= m_labels.data() + vi_lo;
+		max_name_width	= m_max_name_width;
+		layout			= m_layout;
 	}
+	else
+	{
+		// Convert and measure visible names only
+		convert_labels(headless_labels, vi_lo, vi_hi);
+		labels			= headless_labels.data();
+		max_name_width	= headless_labels.max_width();
+		layout			= lay_out({ page_width, page_height, m_show_header, m_show_legend, max_name_width }, &headless_legend);
+	}
+	const t_legend& legend	= headless ? headless_legend : m_legend;
+	int left_axis_width		= layout.m_left_axis_width;
+	int plot_width			= layout.m_plot_width;
+	int chart_top			= layout.m_chart_top;
+	int chart_height		= layout.m_chart_height;
+	bool show_header		= layout.m_show_header;
+	bool show_legend		= layout.m_show_legend;
 
 	// Get scroll and zoom positions.
-	double vp_top = chartviewer().getViewPortTop();
-	double vp_height = chartviewer().getViewPortHeight();
+	double vp_top = request.m_vp_top;
+	double vp_height = request.m_vp_height;
 
 	// Header and legend.
 	shared_ptr<XYChart> chart_ptr(new XYChart(page_width, page_height));
@@ -339,7 +1235,9 @@ t_chart_ptr t_rms_graph::get_chart(int page_width, int page_height, bool vector_
 	auto hgrid_color = [this](int color) -> int { return m_show_horizontal_marks ? color : Chart::Transparent; };
 	int vgrid_color = m_show_vertical_marks ? MAIN_MARK_COLOR : Chart::Transparent;
 
-	m_plot_bounds = CRect(left_axis_width, chart_top, left_axis_width + plot_width, chart_top + chart_height);
+	CRect plot_bounds(left_axis_width, chart_top, left_axis_width + plot_width, chart_top + chart_height);
+	if (!headless)
+		m_plot_bounds = plot_bounds;
 	PlotArea* plot_area = chart.setPlotArea(left_axis_width, chart_top, plot_width, chart_height,
 		Chart::Transparent, -1, -1, hgrid_color(MAIN_MARK_COLOR), vgrid_color);
 
@@ -347,9 +1245,26 @@ t_chart_ptr t_rms_graph::get_chart(int page_width, int page_height, bool vector_
 		m_header.plot(chart);
 
 	if (show_legend)
-		m_legend.plot(chart);
+		legend.plot(chart);
 
-	m_component_bar_set.set_zoom(m_component_info_set);
+	// One bar per plot pixel column at most, then refit axes if zoom moved
+	int level;
+	t_axis_bounds axes;
+	if (!headless)
+	{
+		m_component_bar_set.set_zoom(m_component_info_set, plot_width);
+		m_component_bar_set.update_axis_bounds();
+		level	= m_component_bar_set.level();
+		axes	= {
+			m_component_bar_set.left_min(), m_component_bar_set.left_max(),
+			m_component_bar_set.right_min(), m_component_bar_set.right_max()
+		};
+	}
+	else
+	{
+		level	= int(t_minmax_pyramid::level_for(vi_lo, vi_hi, plot_width));
+		axes	= m_component_bar_set.axis_bounds(vi_lo, vi_hi);
+	}
 
 	Axis* left_axis			= chart.yAxis();
 	Axis* right_axis		= chart.yAxis2();
@@ -358,16 +1273,16 @@ t_chart_ptr t_rms_graph::get_chart(int page_width, int page_height, bool vector_
 
 	bool show_axes			= !m_component_info_set.empty() && (
 		!dataset().empty()
-		|| m_component_bar_set.left_max() > 0
-		|| m_component_bar_set.right_max() > 0
+		|| axes.m_left_max > 0
+		|| axes.m_right_max > 0
 	);
 
 	if (show_axes)
 	{
 		if (use_left_axis)
 		{
-			double left_min			= m_component_bar_set.left_min();
-			double left_max			= m_component_bar_set.left_max();
+			double left_min			= axes.m_left_min;
+			double left_max			= axes.m_left_max;
 			double left_range		= left_max - left_min;
 			double axis_max			= left_max - left_range * vp_top;
 			double axis_min			= axis_max - left_range * vp_height;
@@ -383,8 +1298,8 @@ t_chart_ptr t_rms_graph::get_chart(int page_width, int page_height, bool vector_
 
 		if (use_right_axis)
 		{
-			double right_min		= m_component_bar_set.right_min();
-			double right_max		= m_component_bar_set.right_max();
+			double right_min		= axes.m_right_min;
+			double right_max		= axes.m_right_max;
 			double right_range		= right_max - right_min;
 			double axis_max			= right_max - right_range * vp_top;
 			double axis_min			= axis_max - right_range * vp_height;
@@ -423,24 +1338,33 @@ t_chart_ptr t_rms_graph::get_chart(int page_width, int page_height, bool vector_
 	}
 
 	auto zoomed = m_component_info_set.zoomed();
-	auto name_count = ::size(zoomed);
+	auto name_count = int(t_minmax_pyramid::bucket_count(level, vi_lo, vi_hi));
+	auto bucket_width = 1 << level;
+	TRACE_COUNTER("bars emitted", name_count);
 
 	if (zoomed)
 	{
 		Axis* name_axis = chart.xAxis();
 		name_axis->setTitle(m_component_label, s_axis_title_font.file(), s_axis_title_font.size());
-		name_axis->setTitlePos(Chart::TopCenter, - m_max_name_width - 16);
+		name_axis->setTitlePos(Chart::TopCenter, - max_name_width - 16);
 		name_axis->setLabelStyle(s_axis_label_font.file(), s_axis_label_font.size(), Chart::TextColor, TOP_DOWN_LABEL_ANGLE);
 
-		vector<t_string> name_strings;
-		name_strings.reserve(name_count);
-		for (auto info(zoomed); info; ++info)
-			name_strings.push_back(LPCSTR(TCHARtoUTF8(info->component_name_cd().c_str())));
-		vector<const t_char*> names;
-		names.reserve(name_count);
-		for (auto& name_string : name_strings)
-			names.push_back(name_string.c_str());
-		auto textbox = name_axis->setLabels(StringArray(names.data(), int(names.size())));
+		// If bars not aggregated, label directly from table
+		StringArray names(labels, vi_hi - vi_lo);
+
+		// Else label each bar with its first component, edge bars being
+		// cut to the view so that holds for them too
+		vector<const char*> headless_bucket_labels;
+		auto& bucket_labels = headless ? headless_bucket_labels : m_bucket_labels;
+		if (bucket_width > 1)
+		{
+			bucket_labels.clear();
+			for (int index = vi_lo; index < vi_hi; ++index)
+				if (index == vi_lo || index % bucket_width == 0)
+					bucket_labels.push_back(labels[index - vi_lo]);
+			names = StringArray(bucket_labels.data(), int(bucket_labels.size()));
+		}
+		auto textbox = name_axis->setLabels(names);
 		if (m_show_component_icons)
 			textbox->setPos(textbox->getLeftX(), textbox->getTopY() + ICON_HEIGHT);
 
@@ -449,16 +1373,49 @@ t_chart_ptr t_rms_graph::get_chart(int page_width, int page_height, bool vector_
 		name_axis->setMargin(0, 0);
 
 		BarLayer *layer = chart.addBarLayer(Chart::Side);
-		m_component_bar_set.add_to_layer(layer);
+		m_component_bar_set.add_to_layer(layer, vi_lo, vi_hi, level);
 		layer->setBarGap(0.4, 0.0);
 		layer->setBorderColor(Chart::Transparent);
 	}
 
+	// Icons only where each bar is a single component, so none narrower
+	// than a pixel column. Interactive renders draw them from an atlas
+	// reaching about a screen beyond each side of the view, so panning
+	// only shifts it; headless renders draw visible icons only.
+	// Collect any icons to draw while state locked.
+	t_icon_key icon_key = { vi_hi - vi_lo, plot_width, m_label_generation };
+	bool show_icons = m_show_component_icons && zoomed && bucket_width == 1;
+	vector<const DrawArea*> icons;
+	int atlas_lo = vi_lo;
+	int atlas_hi = vi_hi;
+	bool collect_icons = show_icons;
+	if (show_icons && !headless)
+	{
+		std::lock_guard<std::mutex> icon_lock(m_icon_mutex);
+		collect_icons = !icon_atlas_covers(icon_key, vi_lo, vi_hi);
+		atlas_lo = std::max(0, vi_lo - icon_key.m_visible_count);
+		atlas_hi = std::min(int(m_component_info_set.size()), vi_hi + icon_key.m_visible_count);
+	}
+	if (collect_icons)
+	{
+		icons.reserve(atlas_hi - atlas_lo);
+		int index = 0;
+		for (const auto& info : m_component_info_set)
+		{
+			if (index >= atlas_hi) break;
+			if (index++ >= atlas_lo)
+				icons.push_back(&component_cd_bitmap(info.component().type()));
+		}
+	}
+	int right_mark_color = hgrid_color(use_right_axis ? m_plot_color_right->m_mark_color : m_plot_color_left->m_mark_color);
+	lock.unlock();
+
+	if (superseded(request)) return nullptr;
+
 	// Plot right axis grid lines
 	if (show_axes)
 	{
 		chart.layout();
-		int right_mark_color = hgrid_color(use_right_axis ? m_plot_color_right->m_mark_color : m_plot_color_left->m_mark_color);
 		DoubleArray ticks(right_axis->getTicks());
 		for (int i = 0; i < ticks.len; ++i)
 		{
@@ -470,22 +1427,43 @@ t_chart_ptr t_rms_graph::get_chart(int page_width, int page_height, bool vector_
 		}
 	}
 
-	chart_ptr->makeChart();
+	if (superseded(request)) return nullptr;
+	{
+		TRACE_SCOPE("makeChart", "graph");
+		chart_ptr->makeChart();
+	}
+
+	// Blit all headless icons at once from a strip of their own
+	if (show_icons && headless)
+	{
+		if (icons.empty()) return chart_ptr;
+		TRACE_SCOPE("icon merge", "graph");
+		DrawArea strip;
+		int margin = draw_icons(strip, icons, plot_width/double(icons.size()));
+		chart_ptr->getDrawArea()->merge(
+			&strip,
+			plot_bounds.left - margin, plot_bounds.bottom + ICON_MARGIN,
+			Chart::TopLeft, 0
+		);
+	}
 
-	if (m_show_component_icons && zoomed)
+	// Blit all interactive icons at once from slice of atlas.
+	// If atlas was replaced for another view meanwhile, a newer render follows.
+	else if (show_icons)
 	{
-		double xinc	= plot_width/double(name_count);
-		double x	= m_plot_bounds.left + 0.5 * xinc;
-		int y		= m_plot_bounds.bottom + ICON_MARGIN;
-		for (const auto& info : range_wrapper(zoomed))
-		{
-			chart_ptr->getDrawArea()->merge(
-				&component_cd_bitmap(info.component().type()),
-				round<int>(x), y,
-				Chart::TopCenter, 0
-			);
-			x += xinc;
-		}
+		if (superseded(request)) return nullptr;
+		TRACE_SCOPE("icon merge", "graph");
+		std::lock_guard<std::mutex> icon_lock(m_icon_mutex);
+		if (!icons.empty())
+			build_icon_atlas(icon_key, atlas_lo, icons);
+		if (!icon_atlas_covers(icon_key, vi_lo, vi_hi))
+			return chart_ptr;
+		const DrawArea& strip = icon_strip(vi_lo);
+		chart_ptr->getDrawArea()->merge(
+			&strip,
+			plot_bounds.left - m_icon_strip_margin, plot_bounds.bottom + ICON_MARGIN,
+			Chart::TopLeft, 0
+		);
 	}
 
 	return chart_ptr;
@@ -6,6 +6,11 @@
 #include "Include2.h"
 #include "Include3.h"
 
+#include <string_view>
+#include <unordered_map>
+
+#include "Trace.h"
+
 
 //----------------------------------------------------------------------
 // t_named_param
@@ -63,6 +68,13 @@ struct t_param_traits
 	static t_string param_string(parameter_type param)
 	{ return t_error(STR_ID_NAME, param); }
 
+	template<typename FUNC>
+	static void for_each_feature(const t_live_simulation& sim, FUNC func)
+	{
+		for (auto& feature : t_project::t_table_traits<FEAT>::table(sim))
+			func(feature.second);
+	}
+
 	static void add_all_features(std::vector<named_parameter_type>& parameters, const t_live_simulation& sim)
 	{
 		for (auto& feature : t_project::t_table_traits<FEAT>::table(sim))
@@ -97,6 +109,12 @@ struct t_param_traits
 // t_param_traits<t_trip>: Parameter handling for trips
 //----------------------------------------------------------------------
 
+// Trips are held by name, where table features are held by id. Batch
+// configurations store trip names, and a trip's position in
+// enabled_trips() moves whenever trips are enabled or disabled, so an
+// id taken from it would not survive plan edits. Only EXPLICIT name
+// resolution goes through t_param_index.
+
 template<>
 struct t_param_traits<t_trip>
 {
@@ -120,6 +138,13 @@ struct t_param_traits<t_trip>
 	static t_string param_string(parameter_type param)
 	{ return param; }
 
+	template<typename FUNC>
+	static void for_each_feature(const t_live_simulation& sim, FUNC func)
+	{
+		for (auto&& trip : sim.get_operating_plan().enabled_trips())
+			func(trip);
+	}
+
 	static void add_all_features(std::vector<named_parameter_type>& parameters, const t_live_simulation& sim)
 	{
 		for (auto&& trip : sim.get_operating_plan().enabled_trips())
@@ -150,6 +175,67 @@ struct t_param_traits<t_trip>
 };
 
 
+//----------------------------------------------------------------------
+// t_param_index: Hashed name index over simulation features
+//----------------------------------------------------------------------
+
+// Built for one query and dropped with it, so it never outlives the
+// features it points to. Names held by more than one feature are left
+// out, and any name not indexed falls back to the simulation's own
+// lookup, so results always match it.
+
+template<typename FEAT>
+class t_param_index
+{
+public:
+
+	using traits = t_param_traits<FEAT>;
+
+	explicit t_param_index(const t_live_simulation& sim)
+	{ traits::for_each_feature(sim, [this](const FEAT& feature) { add(&feature); }); }
+
+	// Index over given features, in order
+	explicit t_param_index(const std::vector<const FEAT*>& features)
+	{
+		for (auto feature : features)
+			add(feature);
+	}
+
+	// Feature with exactly this name, or null if none or several
+	const FEAT* find(const t_string& name) const
+	{
+		auto entry = m_names.find(name);
+		return entry == m_names.end() ? nullptr : entry->second;
+	}
+
+	// Feature with name as simulation would find it, or null
+	const FEAT* resolve(const t_live_simulation& sim, const t_string& name) const
+	{
+		auto feature = find(name);
+		return feature ? feature : traits::feature(sim, name);
+	}
+
+	// Features in simulation order
+	const std::vector<const FEAT*>& features() const
+	{ return m_features; }
+
+private:
+
+	void add(const FEAT* feature)
+	{
+		m_features.push_back(feature);
+
+		// If name already taken, leave it to simulation
+		auto entry = m_names.emplace(traits::to_name(feature), feature);
+		if (!entry.second)
+			entry.first->second = nullptr;
+	}
+
+	std::vector<const FEAT*>						m_features;
+	std::unordered_map<t_string, const FEAT*>		m_names;		// Null if not unique
+};
+
+
 //----------------------------------------------------------------------
 // get_item_parameters
 //----------------------------------------------------------------------
@@ -161,6 +247,8 @@ std::vector<typename t_param_traits<FEAT>::named_parameter_type> get_item_parame
 	const t_live_simulation& sim
 )
 {
+	TRACE_SCOPE("get_item_parameters", "params");
+
 	// Parameter list
 	using traits = t_param_traits<FEAT>;
 	std::vector<traits::named_parameter_type> parameters;
@@ -171,16 +259,21 @@ std::vector<typename t_param_traits<FEAT>::named_parameter_type> get_item_parame
 	// Multiple reports using each batch parameter
 	case t_batch_query_param::t_type::EXPLICIT:
 
-		// For each batch query parameter
-		for (auto& name : query_param.m_values)
+		parameters.reserve(query_param.m_values.size());
 		{
-			// If feature not found in simulation, choke
-			auto feature = traits::feature(sim, name);
-			if (!feature)
-				throw t_log_event(BA022, NO_LINE_NUMBER, name);
+			// For each batch query parameter
+			t_param_index<FEAT> index(sim);
+			TRACE_COUNTER("parameter lookups", query_param.m_values.size());
+			for (auto& name : query_param.m_values)
+			{
+				// If feature not found in simulation, choke
+				auto feature = index.resolve(sim, name);
+				if (!feature)
+					throw t_log_event(BA022, NO_LINE_NUMBER, name);
 
-			// Add feature to parameters
-			parameters.emplace_back(traits::to_name(feature), traits::to_parameter(feature));
+				// Add feature to parameters
+				parameters.emplace_back(traits::to_name(feature), traits::to_parameter(feature));
+			}
 		}
 		break;
 
@@ -231,6 +324,8 @@ std::vector<typename t_param_traits<FEAT>::named_listparam_type> get_list_parame
 	const t_live_simulation& sim
 )
 {
+	TRACE_SCOPE("get_list_parameters", "params");
+
 	// Parameter list
 	using traits = t_param_traits<FEAT>;
 	traits::named_listparam_type parameter;
@@ -242,16 +337,20 @@ std::vector<typename t_param_traits<FEAT>::named_listparam_type> get_list_parame
 	// Single report using all batch parameters
 	case t_batch_query_param::t_type::EXPLICIT:
 
-		// For each batch query parameter
-		for (auto& name : query_param.m_values)
 		{
-			// If parameter not found in simulation, choke
-			auto feature = traits::feature(sim, name);
-			if (!feature)
-				throw t_log_event(BA022, NO_LINE_NUMBER, name);
+			// For each batch query parameter
+			t_param_index<FEAT> index(sim);
+			TRACE_COUNTER("parameter lookups", query_param.m_values.size());
+			for (auto& name : query_param.m_values)
+			{
+				// If parameter not found in simulation, choke
+				auto feature = index.resolve(sim, name);
+				if (!feature)
+					throw t_log_event(BA022, NO_LINE_NUMBER, name);
 
-			// Add item to parameter
-			traits::add_feature(parameter, *feature);
+				// Add item to parameter
+				traits::add_feature(parameter, *feature);
+			}
 		}
 
 		// Add parameter to list
@@ -312,3 +411,183 @@ std::vector<typename t_param_traits<FEAT>::named_listparam_type> get_list_parame
 	return parameters;
 }
 
+
+//----------------------------------------------------------------------
+// t_param_view: Parameter referring into simulation tables
+//----------------------------------------------------------------------
+
+// Views hold only a feature and copy nothing; name and parameter are
+// read from the feature, and a t_named_param is built only when
+// materialized.
+
+template<typename FEAT>
+struct t_param_view
+{
+	using traits = t_param_traits<FEAT>;
+	using parameter_type = typename traits::parameter_type;
+
+	explicit t_param_view(const FEAT* feature) :
+		m_feature(feature)
+	{ }
+
+	const FEAT* feature() const						{ return m_feature; }
+	std::basic_string_view<t_char> name() const		{ return traits::to_name(m_feature); }
+	parameter_type param() const					{ return traits::to_parameter(m_feature); }
+
+	typename traits::named_parameter_type materialize() const
+	{ return { traits::to_name(m_feature), param() }; }
+
+	typename traits::named_listparam_type materialize_list() const
+	{ return { traits::to_name(m_feature), typename traits::listparam_type(1, param()) }; }
+
+private:
+
+	const FEAT*							m_feature;
+};
+
+
+//----------------------------------------------------------------------
+// t_param_range: Lazy range of parameter views
+//----------------------------------------------------------------------
+
+// Iterates a list of feature pointers; views are made as it goes.
+
+template<typename FEAT>
+class t_param_range
+{
+public:
+
+	using traits = t_param_traits<FEAT>;
+	using view_type = t_param_view<FEAT>;
+
+	// Input only, as views are yielded by value rather than by
+	// reference; size() and operator[] on the range cover random access
+	class iterator
+	{
+	public:
+
+		using iterator_category = std::input_iterator_tag;
+		using value_type = view_type;
+		using difference_type = std::ptrdiff_t;
+		using pointer = void;
+		using reference = view_type;
+
+		iterator() = default;
+
+		explicit iterator(const FEAT* const* feature) :
+			m_feature(feature)
+		{ }
+
+		view_type operator*() const						{ return view(*m_feature); }
+		iterator& operator++()							{ ++m_feature; return *this; }
+		iterator operator++(int)						{ return iterator(m_feature++); }
+		bool operator==(iterator other) const			{ return m_feature == other.m_feature; }
+		bool operator!=(iterator other) const			{ return m_feature != other.m_feature; }
+
+	private:
+
+		const FEAT* const*				m_feature = nullptr;
+	};
+
+	t_param_range() = default;
+
+	explicit t_param_range(std::vector<const FEAT*> features) :
+		m_features(std::move(features))
+	{ }
+
+	iterator begin() const				{ return iterator(m_features.data()); }
+	iterator end() const				{ return iterator(m_features.data() + m_features.size()); }
+	size_t size() const					{ return m_features.size(); }
+	bool empty() const					{ return m_features.empty(); }
+	view_type operator[](size_t i) const	{ return view(m_features[i]); }
+
+	std::vector<typename traits::named_parameter_type> materialize() const
+	{
+		std::vector<typename traits::named_parameter_type> parameters;
+		parameters.reserve(size());
+		for (auto view : *this)
+			parameters.push_back(view.materialize());
+		return parameters;
+	}
+
+private:
+
+	static view_type view(const FEAT* feature)
+	{ return view_type(feature); }
+
+	std::vector<const FEAT*>			m_features;
+};
+
+
+//----------------------------------------------------------------------
+// get_item_views
+//----------------------------------------------------------------------
+
+// As get_item_parameters, but yields views. ALL queries collect only
+// feature pointers, so nothing is copied per feature.
+// List queries have no view form yet; use get_list_parameters.
+
+template<typename FEAT>
+t_param_range<FEAT> get_item_views(
+	const t_batch_query_param& query_param,
+	const typename t_param_traits<FEAT>::parameter_type& config_parameter,
+	const t_live_simulation& sim
+)
+{
+	using traits = t_param_traits<FEAT>;
+
+	// Depending on parameter type
+	switch (query_param.type())
+	{
+	// Multiple reports using each batch parameter
+	case t_batch_query_param::t_type::EXPLICIT:
+		{
+			// For each batch query parameter
+			t_param_index<FEAT> index(sim);
+			std::vector<const FEAT*> features;
+			features.reserve(query_param.m_values.size());
+			for (auto& name : query_param.m_values)
+			{
+				// If feature not found in simulation, choke
+				auto feature = index.resolve(sim, name);
+				if (!feature)
+					throw t_log_event(BA022, NO_LINE_NUMBER, name);
+
+				// Add feature to views
+				features.push_back(feature);
+			}
+			return t_param_range<FEAT>(std::move(features));
+		}
+
+	// Single report using configuration parameter
+	case t_batch_query_param::t_type::CONFIG:
+
+		// If configuration parameter deferred, choke
+		if (traits::deferred(config_parameter))
+			throw t_log_event(BA017, NO_LINE_NUMBER);
+		{
+			// If feature not found in simulation, choke
+			auto feature = traits::feature(sim, config_parameter);
+			if (!feature)
+				throw t_log_event(BA018, NO_LINE_NUMBER, traits::param_string(config_parameter));
+
+			return t_param_range<FEAT>(std::vector<const FEAT*>(1, feature));
+		}
+
+	// Multiple reports, one per simulation feature
+	case t_batch_query_param::t_type::ALL:
+
+		{
+			std::vector<const FEAT*> features;
+			traits::for_each_feature(sim, [&features](const FEAT& feature) { features.push_back(&feature); });
+			return t_param_range<FEAT>(std::move(features));
+		}
+
+	// Single report, all simulation features
+	case t_batch_query_param::t_type::SINGLE:
+	default:
+
+		// Choke
+		throw t_log_event(BA020, NO_LINE_NUMBER);
+	}
+}
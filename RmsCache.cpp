@@ -0,0 +1,130 @@
+// Sample code - David Wilson
+
+#include "Include1.h"
+#include "Include2.h"
+#include "Include3.h"
+
+#include "RmsCache.h"
+
+
+// ------------------------------------------------------------------------
+// t_rms_cache
+// ------------------------------------------------------------------------
+
+t_rms_cache& t_rms_cache::shared()
+{
+	static t_rms_cache s_cache;
+	return s_cache;
+}
+
+std::optional<double> t_rms_cache::find(const t_rms_cache_key& key)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto entry = m_index.find(key);
+	if (entry == m_index.end())
+	{
+		++m_misses;
+		return std::nullopt;
+	}
+
+	// Mark most recently used
+	m_entries.splice(m_entries.begin(), m_entries, entry->second);
+	++m_hits;
+	return entry->second->m_value;
+}
+
+void t_rms_cache::insert(const t_rms_cache_key& key, double value)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	// If already cached, update and mark most recently used
+	if (auto entry = m_index.find(key); entry != m_index.end())
+	{
+		entry->second->m_value = value;
+		m_entries.splice(m_entries.begin(), m_entries, entry->second);
+		return;
+	}
+
+	// Charge stored copy, and release exactly that on eviction
+	m_entries.push_front({ key, value, 0 });
+	auto& entry = m_entries.front();
+	entry.m_bytes = entry_bytes(entry.m_key);
+	m_index.emplace(entry.m_key, m_entries.begin());
+	m_bytes += entry.m_bytes;
+	evict();
+}
+
+void t_rms_cache::erase_run(uint64_t run)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (auto entry = m_entries.begin(); entry != m_entries.end();)
+	{
+		if (entry->m_key.m_run != run)
+		{
+			++entry;
+			continue;
+		}
+		m_bytes -= entry->m_bytes;
+		m_index.erase(entry->m_key);
+		entry = m_entries.erase(entry);
+	}
+}
+
+void t_rms_cache::clear()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_index.clear();
+	m_entries.clear();
+	m_bytes = 0;
+}
+
+void t_rms_cache::set_budget(size_t budget)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_budget = budget;
+	evict();
+}
+
+size_t t_rms_cache::budget() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_budget;
+}
+
+size_t t_rms_cache::bytes() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_bytes;
+}
+
+size_t t_rms_cache::hits() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_hits;
+}
+
+size_t t_rms_cache::misses() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_misses;
+}
+
+size_t t_rms_cache::entry_bytes(const t_rms_cache_key&)
+{
+	// List node and index node; keys hold nothing on heap
+	constexpr size_t node_bytes = sizeof(t_entry) + 2*sizeof(void*);
+	constexpr size_t index_bytes = sizeof(t_rms_cache_key) + sizeof(t_entries::iterator) + 2*sizeof(void*);
+	return node_bytes + index_bytes;
+}
+
+void t_rms_cache::evict()
+{
+	// Evict least recently used until within budget
+	while (m_bytes > m_budget && !m_entries.empty())
+	{
+		auto& oldest = m_entries.back();
+		m_bytes -= oldest.m_bytes;
+		m_index.erase(oldest.m_key);
+		m_entries.pop_back();
+	}
+}
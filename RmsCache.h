@@ -0,0 +1,114 @@
+// David Wilson - Code Sample
+
+#pragma once
+
+#include "Include1.h"
+#include "Include2.h"
+#include "Include3.h"
+
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+#include "RmsData.h"
+
+//----------------------------------------------------------------------
+// t_rms_cache_key: Identifies one component's RMS computation
+//----------------------------------------------------------------------
+
+// Window is the bar's RMS window in seconds, or 0 where the calculator
+// sets it from the time step. Samples is the length of the run the
+// result covers, so results taken while a run grows are not reused once
+// it has grown.
+
+struct t_rms_cache_key
+{
+	uint64_t						m_run;
+	t_id							m_component;
+	t_rms_quantity					m_quantity;
+	double							m_window;
+	double							m_time_step;
+	uint64_t						m_samples;
+
+	bool operator==(const t_rms_cache_key& other) const
+	{
+		return m_run == other.m_run
+			&& m_component == other.m_component
+			&& m_quantity == other.m_quantity
+			&& m_window == other.m_window
+			&& m_time_step == other.m_time_step
+			&& m_samples == other.m_samples;
+	}
+};
+
+struct t_rms_cache_key_hash
+{
+	size_t operator()(const t_rms_cache_key& key) const
+	{
+		size_t hash = std::hash<uint64_t>()(key.m_run);
+		hash = hash*31 + std::hash<t_id>()(key.m_component);
+		hash = hash*31 + std::hash<int32_t>()(int32_t(key.m_quantity));
+		hash = hash*31 + std::hash<double>()(key.m_window);
+		hash = hash*31 + std::hash<double>()(key.m_time_step);
+		hash = hash*31 + std::hash<uint64_t>()(key.m_samples);
+		return hash;
+	}
+};
+
+
+//----------------------------------------------------------------------
+// t_rms_cache: Shared RMS results with LRU eviction
+//----------------------------------------------------------------------
+
+// Shared by interactive graphs and batch reports, possibly on several
+// threads. Least recently used results are evicted once the memory
+// budget is exceeded.
+
+class t_rms_cache
+{
+public:
+
+	static constexpr size_t DEFAULT_BUDGET = 64 << 20;
+
+	explicit t_rms_cache(size_t budget = DEFAULT_BUDGET) :
+		m_budget(budget)
+	{ }
+
+	// Cache shared by all graphs and reports in session
+	static t_rms_cache& shared();
+
+	std::optional<double> find(const t_rms_cache_key& key);
+	void insert(const t_rms_cache_key& key, double value);
+
+	// Drop all results for run, e.g. when it is rerun
+	void erase_run(uint64_t run);
+	void clear();
+
+	void set_budget(size_t budget);
+	size_t budget() const;
+	size_t bytes() const;
+	size_t hits() const;
+	size_t misses() const;
+
+private:
+
+	struct t_entry
+	{
+		t_rms_cache_key				m_key;
+		double						m_value;
+		size_t						m_bytes;		// As charged against budget
+	};
+	using t_entries = std::list<t_entry>;
+
+	static size_t entry_bytes(const t_rms_cache_key& key);
+	void evict();
+
+	mutable std::mutex				m_mutex;
+	t_entries						m_entries;		// Most recent first
+	std::unordered_map<t_rms_cache_key, t_entries::iterator, t_rms_cache_key_hash>	m_index;
+	size_t							m_budget;
+	size_t							m_bytes = 0;
+	size_t							m_hits = 0;
+	size_t							m_misses = 0;
+};
@@ -0,0 +1,503 @@
+// David Wilson - Code Sample
+
+#pragma once
+
+#include "Include1.h"
+#include "Include2.h"
+#include "Include3.h"
+
+#include <deque>
+
+
+//----------------------------------------------------------------------
+// t_rms_quantity: Quantity an RMS bar series plots
+//----------------------------------------------------------------------
+
+// Identifies cached and saved results independently of display names.
+// Saved in summary files, so values must not be reused or reordered.
+
+enum class t_rms_quantity : int32_t
+{
+	CURRENT,
+	POWER,
+	ENERGY,
+};
+
+
+//----------------------------------------------------------------------
+// t_rms_windows: Sliding-window RMS for any window, every component
+//----------------------------------------------------------------------
+
+// Prefix sums of squares of the last capacity steps are kept in a ring,
+// step-major, so the RMS over any window of up to capacity steps ending
+// at the latest step is one subtraction. One instance thus serves 1 s,
+// 10 s, 1 min and 1 h windows at once, and switching window needs no
+// pass over the samples. Memory is bounded by capacity, not run length.
+// Sums are rebased on the oldest kept step each time the ring wraps, so
+// they stay of the order of one window's total and keep their precision.
+
+class t_rms_windows
+{
+public:
+
+	void reset(size_t component_count, size_t capacity)
+	{
+		m_component_count	= component_count;
+		m_capacity			= std::max<size_t>(capacity, 1);
+		m_sums.assign((m_capacity + 1)*component_count, 0.0);
+		m_steps				= 0;
+	}
+
+	size_t component_count() const		{ return m_component_count; }
+	size_t capacity() const				{ return m_capacity; }
+	uint64_t steps() const				{ return m_steps; }
+
+	void add_step(const double* samples)
+	{
+		const double* last = row(m_steps);
+		double* next = row(m_steps + 1);
+		for (size_t i = 0; i < m_component_count; ++i)
+			next[i] = last[i] + samples[i]*samples[i];
+
+		// Ring wrapped, rebase on oldest kept step
+		if (++m_steps % (m_capacity + 1) == 0)
+		{
+			std::vector<double> base(row(m_steps - m_capacity), row(m_steps - m_capacity) + m_component_count);
+			for (size_t slot = 0; slot <= m_capacity; ++slot)
+			{
+				double* sums = m_sums.data() + slot*m_component_count;
+				for (size_t i = 0; i < m_component_count; ++i)
+					sums[i] -= base[i];
+			}
+		}
+	}
+
+	// RMS of component over last window steps, or over steps so far
+	// if fewer; windows longer than capacity are cut to capacity
+	double rms(size_t component, size_t window) const
+	{
+		auto samples = std::min<uint64_t>(m_steps, std::min(window, m_capacity));
+		if (samples == 0) return 0;
+		double sum = row(m_steps)[component] - row(m_steps - samples)[component];
+		return std::sqrt(std::max(0.0, sum)/double(samples));
+	}
+
+private:
+
+	double* row(uint64_t step)
+	{ return m_sums.data() + size_t(step % (m_capacity + 1))*m_component_count; }
+	const double* row(uint64_t step) const
+	{ return m_sums.data() + size_t(step % (m_capacity + 1))*m_component_count; }
+
+	size_t							m_component_count = 0;
+	size_t							m_capacity = 1;
+	std::vector<double>				m_sums;			// Ring of prefix sums, step-major
+	uint64_t						m_steps = 0;
+};
+
+
+//----------------------------------------------------------------------
+// t_minmax_pyramid: Multi-resolution aggregate of bar data
+//----------------------------------------------------------------------
+
+// Level k holds min, max and sum for aligned buckets of 2^k bars, each
+// level built from the one below. Level 0 is the data itself, which is
+// not copied and must outlive the pyramid until next build. The levels
+// form a bottom-up segment tree, so min and max over any bar range take
+// O(log n).
+
+class t_minmax_pyramid
+{
+public:
+
+	void clear()
+	{
+		m_data = nullptr;
+		m_size = 0;
+		m_levels.clear();
+	}
+
+	void build(const double* data, size_t size)
+	{
+		m_data = data;
+		m_size = size;
+
+		// Levels keep their storage between builds of the same size,
+		// so rebuilding after each update does not allocate
+		size_t level_count = 0;
+		while ((size_t(1) << (level_count + 1)) < size*2)
+			++level_count;
+		m_levels.resize(level_count);
+
+		for (size_t level = 1; level <= level_count; ++level)
+		{
+			auto count = bucket_count(level, 0, size);
+			auto& next = m_levels[level - 1];
+			next.m_min.resize(count);
+			next.m_max.resize(count);
+			next.m_sum.resize(count);
+
+			// Pair buckets of level below; last bucket may have no partner
+			for (size_t i = 0; i < count; ++i)
+			{
+				auto lo = 2*i, hi = std::min(2*i + 2, bucket_count(level - 1, 0, size));
+				next.m_min[i] = next.m_max[i] = next.m_sum[i] = 0;
+				for (auto j = lo; j < hi; ++j)
+				{
+					double min_value = min(level - 1, j);
+					double max_value = max(level - 1, j);
+					next.m_min[i] = j == lo ? min_value : std::min(next.m_min[i], min_value);
+					next.m_max[i] = j == lo ? max_value : std::max(next.m_max[i], max_value);
+					next.m_sum[i] += sum(level - 1, j);
+				}
+			}
+		}
+	}
+
+	size_t size() const				{ return m_size; }
+	size_t levels() const			{ return m_levels.size() + 1; }
+
+	double min(size_t level, size_t bucket) const
+	{ return level == 0 ? m_data[bucket] : m_levels[level - 1].m_min[bucket]; }
+
+	double max(size_t level, size_t bucket) const
+	{ return level == 0 ? m_data[bucket] : m_levels[level - 1].m_max[bucket]; }
+
+	double sum(size_t level, size_t bucket) const
+	{ return level == 0 ? m_data[bucket] : m_levels[level - 1].m_sum[bucket]; }
+
+	double mean(size_t level, size_t bucket) const
+	{
+		auto lo = bucket << level;
+		auto hi = std::min(lo + (size_t(1) << level), m_size);
+		return sum(level, bucket)/double(hi - lo);
+	}
+
+	// Value of largest magnitude in bucket, so peaks survive aggregation
+	double extreme(size_t level, size_t bucket) const
+	{
+		double min_value = min(level, bucket);
+		double max_value = max(level, bucket);
+		return max_value >= -min_value ? max_value : min_value;
+	}
+
+	// Min and max over bars [lo, hi), from at most two buckets per level.
+	// Range must not be empty.
+	std::pair<double, double> minmax(size_t lo, size_t hi) const
+	{
+		ASSERT(lo < hi && hi <= m_size);
+		double min_value = m_data[lo];
+		double max_value = min_value;
+
+		// Climb levels, taking unpaired buckets at either end of range
+		for (size_t level = 0; lo < hi; ++level, lo >>= 1, hi >>= 1)
+		{
+			if (lo & 1)
+			{
+				min_value = std::min(min_value, min(level, lo));
+				max_value = std::max(max_value, max(level, lo));
+				++lo;
+			}
+			if (hi & 1)
+			{
+				--hi;
+				min_value = std::min(min_value, min(level, hi));
+				max_value = std::max(max_value, max(level, hi));
+			}
+		}
+		return { min_value, max_value };
+	}
+
+	// Buckets at level touching bars [lo, hi)
+	static size_t bucket_count(size_t level, size_t lo, size_t hi)
+	{ return hi <= lo ? 0 : ((hi - 1) >> level) - (lo >> level) + 1; }
+
+	// Finest level giving at most max_buckets buckets over bars [lo, hi)
+	static size_t level_for(size_t lo, size_t hi, size_t max_buckets)
+	{
+		size_t level = 0;
+		while (bucket_count(level, lo, hi) > std::max<size_t>(max_buckets, 1))
+			++level;
+		return level;
+	}
+
+private:
+
+	struct t_level
+	{
+		std::vector<double>			m_min;
+		std::vector<double>			m_max;
+		std::vector<double>			m_sum;
+	};
+
+	const double*					m_data = nullptr;
+	size_t							m_size = 0;
+	std::vector<t_level>			m_levels;
+};
+
+
+//----------------------------------------------------------------------
+// t_column_history: Bar values per update, with bounded retention
+//----------------------------------------------------------------------
+
+// Each update adds a column of one value per component. RING keeps the
+// last capacity columns; DECIMATE keeps at most capacity columns spread
+// over the whole run, halving resolution whenever full; ALL keeps
+// everything. Storage grows as columns arrive and never past capacity
+// columns. A column of different width starts a new history. Min and
+// max over retained columns are kept exact by monotonic deques of
+// column extrema, so evicting a column never needs a rescan. They also
+// take in latest column, which DECIMATE may not retain, so bounds
+// always cover what bars show.
+
+class t_column_history
+{
+public:
+
+	enum class t_retention
+	{
+		ALL,
+		RING,
+		DECIMATE,
+	};
+
+	void set_retention(t_retention retention, size_t capacity)
+	{
+		m_retention	= retention;
+		m_capacity	= std::max<size_t>(capacity, 2);
+		clear();
+	}
+
+	void clear()
+	{
+		m_values.clear();
+		m_column_min.clear();
+		m_column_max.clear();
+		m_latest.clear();
+		m_latest_min	= 0;
+		m_latest_max	= 0;
+		m_min_deque.clear();
+		m_max_deque.clear();
+		m_width		= 0;
+		m_first		= 0;
+		m_count		= 0;
+		m_added		= 0;
+		m_stride	= 1;
+	}
+
+	t_retention retention() const		{ return m_retention; }
+	size_t capacity() const				{ return m_capacity; }
+	size_t width() const				{ return m_width; }
+	size_t columns() const				{ return m_count; }
+	bool empty() const					{ return m_added == 0; }
+
+	// Updates between retained columns; above one only when decimating
+	size_t stride() const				{ return m_stride; }
+
+	// Retained column, oldest first
+	const double* column(size_t i) const
+	{ return m_values.data() + slot(i)*m_width; }
+
+	// Most recent column, retained or not
+	const double* latest() const		{ return m_latest.data(); }
+
+	// Over retained columns and latest; zero if none
+	double min() const					{ return m_min_deque.empty() ? m_latest_min : std::min(m_min_deque.front().second, m_latest_min); }
+	double max() const					{ return m_max_deque.empty() ? m_latest_max : std::max(m_max_deque.front().second, m_latest_max); }
+
+	void add(const double* first, const double* last)
+	{
+		// If component count changed, history no longer lines up
+		auto width = size_t(last - first);
+		if (m_added != 0 && width != m_width)
+			clear();
+		m_width = width;
+		m_latest.assign(first, last);
+
+		// Column extrema in one vectorizable pass
+		double column_min = width ? *first : 0;
+		double column_max = column_min;
+		for (auto value = first; value != last; ++value)
+		{
+			column_min = std::min(column_min, *value);
+			column_max = std::max(column_max, *value);
+		}
+		m_latest_min = column_min;
+		m_latest_max = column_max;
+
+		auto index = m_added++;
+		switch (m_retention)
+		{
+		case t_retention::ALL:
+			append(first, last, column_min, column_max);
+			push(index, column_min, column_max);
+			break;
+
+		case t_retention::RING:
+
+			// If full, overwrite oldest and drop it from deques
+			if (m_count == m_capacity)
+			{
+				auto target = m_first;
+				m_first = (m_first + 1) % m_capacity;
+				expire(index - (m_capacity - 1));
+				std::copy(first, last, m_values.begin() + target*m_width);
+				m_column_min[target] = column_min;
+				m_column_max[target] = column_max;
+			}
+			else
+				append(first, last, column_min, column_max);
+			push(index, column_min, column_max);
+			break;
+
+		case t_retention::DECIMATE:
+
+			// If full, keep every other column at twice the stride
+			if (m_count == m_capacity && index % m_stride == 0)
+				compact();
+			if (index % m_stride != 0)
+				break;
+			append(first, last, column_min, column_max);
+			push(index, column_min, column_max);
+			break;
+		}
+	}
+
+private:
+
+	size_t slot(size_t i) const
+	{ return m_retention == t_retention::RING ? (m_first + i) % m_capacity : i; }
+
+	// Add column after retained ones, growing storage up to capacity
+	void append(const double* first, const double* last, double column_min, double column_max)
+	{
+		auto size = (m_count + 1)*m_width;
+		if (m_retention != t_retention::ALL && m_values.capacity() < size)
+			m_values.reserve(std::min(std::max(size, 2*m_values.capacity()), m_capacity*m_width));
+		m_values.resize(m_count*m_width);
+		m_values.insert(m_values.end(), first, last);
+		m_column_min.resize(m_count);
+		m_column_min.push_back(column_min);
+		m_column_max.resize(m_count);
+		m_column_max.push_back(column_max);
+		++m_count;
+	}
+
+	// Add column to deques, dropping entries it dominates
+	void push(uint64_t index, double column_min, double column_max)
+	{
+		while (!m_min_deque.empty() && m_min_deque.back().second >= column_min)
+			m_min_deque.pop_back();
+		m_min_deque.emplace_back(index, column_min);
+		while (!m_max_deque.empty() && m_max_deque.back().second <= column_max)
+			m_max_deque.pop_back();
+		m_max_deque.emplace_back(index, column_max);
+	}
+
+	// Drop deque entries for columns before oldest
+	void expire(uint64_t oldest)
+	{
+		while (!m_min_deque.empty() && m_min_deque.front().first < oldest)
+			m_min_deque.pop_front();
+		while (!m_max_deque.empty() && m_max_deque.front().first < oldest)
+			m_max_deque.pop_front();
+	}
+
+	void compact()
+	{
+		// Keep even columns, then refill deques from kept extrema
+		size_t kept = 0;
+		for (size_t i = 0; i < m_count; i += 2, ++kept)
+		{
+			if (i != kept)
+				std::copy_n(m_values.begin() + i*m_width, m_width, m_values.begin() + kept*m_width);
+			m_column_min[kept] = m_column_min[i];
+			m_column_max[kept] = m_column_max[i];
+		}
+		m_count = kept;
+		m_stride *= 2;
+
+		m_min_deque.clear();
+		m_max_deque.clear();
+		for (size_t i = 0; i < m_count; ++i)
+			push(i*m_stride, m_column_min[i], m_column_max[i]);
+	}
+
+	using t_extremum = std::pair<uint64_t, double>;		// Column index, value
+
+	t_retention						m_retention = t_retention::ALL;
+	size_t							m_capacity = 2;
+	std::vector<double>				m_values;		// Retained columns, by slot
+	std::vector<double>				m_column_min;	// By slot
+	std::vector<double>				m_column_max;	// By slot
+	std::vector<double>				m_latest;
+	double							m_latest_min = 0;
+	double							m_latest_max = 0;
+	std::deque<t_extremum>			m_min_deque;	// Increasing values
+	std::deque<t_extremum>			m_max_deque;	// Decreasing values
+	size_t							m_width = 0;
+	size_t							m_first = 0;	// Slot of oldest column in ring
+	size_t							m_count = 0;
+	uint64_t						m_added = 0;
+	size_t							m_stride = 1;
+};
+
+
+//----------------------------------------------------------------------
+// t_label_table: Interned UTF-8 labels with measured widths
+//----------------------------------------------------------------------
+
+// All labels share one text buffer, and a parallel pointer array hands
+// out any slice as a contiguous const char* array without allocating.
+// Pointers are valid from seal() until next clear().
+
+class t_label_table
+{
+public:
+
+	void clear()
+	{
+		m_text.clear();
+		m_offsets.clear();
+		m_labels.clear();
+		m_widths.clear();
+		m_max_width = 0;
+	}
+
+	void reserve(size_t count)
+	{
+		m_offsets.reserve(count);
+		m_widths.reserve(count);
+	}
+
+	void add(const char* label, int width)
+	{
+		m_offsets.push_back(m_text.size());
+		m_text.append(label).push_back('\0');
+		m_widths.push_back(width);
+		at_least(m_max_width, width);
+	}
+
+	// Fix text buffer and point labels into it
+	void seal()
+	{
+		m_labels.resize(m_offsets.size());
+		for (size_t i = 0; i < m_offsets.size(); ++i)
+			m_labels[i] = m_text.data() + m_offsets[i];
+	}
+
+	size_t size() const							{ return m_labels.size(); }
+	bool empty() const							{ return m_labels.empty(); }
+	const char* const* data() const				{ return m_labels.data(); }
+	const char* operator[](size_t i) const		{ return m_labels[i]; }
+	int width(size_t i) const					{ return m_widths[i]; }
+	int max_width() const						{ return m_max_width; }
+
+private:
+
+	std::string						m_text;
+	std::vector<size_t>				m_offsets;
+	std::vector<const char*>		m_labels;
+	std::vector<int>				m_widths;
+	int								m_max_width = 0;
+};
@@ -0,0 +1,141 @@
+// Sample code - David Wilson
+
+#include "Include1.h"
+#include "Include2.h"
+#include "Include3.h"
+
+#include "RmsSummary.h"
+
+
+// ------------------------------------------------------------------------
+// t_rms_summary
+// ------------------------------------------------------------------------
+
+const t_rms_summary::t_table* t_rms_summary::find(t_rms_quantity quantity, double window, double time_step) const
+{
+	for (auto& table : m_tables)
+	{
+		if (table.m_quantity == quantity && table.m_window == window && table.m_time_step == time_step)
+			return &table;
+	}
+	return nullptr;
+}
+
+bool t_rms_summary::save(LPCTSTR path) const
+{
+	// Build whole file in memory; summaries are small
+	std::vector<char> buffer;
+	auto append = [&buffer](const void* data, size_t bytes)
+	{
+		auto first = static_cast<const char*>(data);
+		buffer.insert(buffer.end(), first, first + bytes);
+	};
+
+	t_file_header header = {};
+	header.m_magic			= t_file_header::MAGIC;
+	header.m_version		= t_file_header::VERSION;
+	header.m_char_size		= sizeof(t_char);
+	header.m_table_count	= uint32_t(m_tables.size());
+	header.m_run			= m_run;
+	header.m_sample_count	= m_sample_count;
+	append(&header, sizeof(header));
+
+	for (auto& table : m_tables)
+	{
+		ASSERT(table.m_ids.size() == table.m_values.size());
+		t_file_table file_table = {};
+		file_table.m_time_step			= table.m_time_step;
+		file_table.m_window				= table.m_window;
+		file_table.m_quantity			= int32_t(table.m_quantity);
+		file_table.m_component_count	= uint32_t(table.m_ids.size());
+		append(&file_table, sizeof(file_table));
+		append(table.m_ids.data(), table.m_ids.size()*sizeof(int64_t));
+		append(table.m_values.data(), table.m_values.size()*sizeof(double));
+	}
+
+	// Write to temporary file, then replace, so readers never see a partial summary
+	t_string temp_path = t_string(path) + _T(".tmp");
+	HANDLE file = ::CreateFile(temp_path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+	DWORD written = 0;
+	bool ok = ::WriteFile(file, buffer.data(), DWORD(buffer.size()), &written, nullptr) && written == buffer.size();
+	::CloseHandle(file);
+	ok = ok && ::MoveFileEx(temp_path.c_str(), path, MOVEFILE_REPLACE_EXISTING);
+	if (!ok)
+		::DeleteFile(temp_path.c_str());
+	return ok;
+}
+
+bool t_rms_summary::load(LPCTSTR path)
+{
+	m_run = 0;
+	m_sample_count = 0;
+	m_tables.clear();
+
+	// Read whole file
+	HANDLE file = ::CreateFile(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+	LARGE_INTEGER file_size = {};
+	std::vector<char> buffer;
+	DWORD read = 0;
+	bool ok = ::GetFileSizeEx(file, &file_size) && file_size.QuadPart < (1ll << 31);
+	if (ok)
+	{
+		buffer.resize(size_t(file_size.QuadPart));
+		ok = ::ReadFile(file, buffer.data(), DWORD(buffer.size()), &read, nullptr) && read == buffer.size();
+	}
+	::CloseHandle(file);
+	if (!ok)
+		return false;
+
+	// Take bytes from buffer, failing on overrun
+	size_t position = 0;
+	auto take = [&buffer, &position](void* data, size_t bytes)
+	{
+		if (buffer.size() - position < bytes) return false;
+		std::copy_n(buffer.data() + position, bytes, static_cast<char*>(data));
+		position += bytes;
+		return true;
+	};
+
+	// If header not as written by this build, choke
+	t_file_header header = {};
+	if (!take(&header, sizeof(header))
+		|| header.m_magic != t_file_header::MAGIC
+		|| header.m_version != t_file_header::VERSION
+		|| header.m_char_size != sizeof(t_char))
+		return false;
+
+	// If more tables claimed than file could hold, choke
+	if ((buffer.size() - position)/sizeof(t_file_table) < header.m_table_count)
+		return false;
+
+	std::vector<t_table> tables(header.m_table_count);
+	for (auto& table : tables)
+	{
+		t_file_table file_table = {};
+		if (!take(&file_table, sizeof(file_table)))
+			return false;
+
+		// If sizes run past end of file, choke
+		auto count = size_t(file_table.m_component_count);
+		if ((buffer.size() - position)/(sizeof(int64_t) + sizeof(double)) < count)
+			return false;
+
+		table.m_quantity	= t_rms_quantity(file_table.m_quantity);
+		table.m_window		= file_table.m_window;
+		table.m_time_step	= file_table.m_time_step;
+		table.m_ids.resize(count);
+		table.m_values.resize(count);
+		if (!take(table.m_ids.data(), count*sizeof(int64_t))
+			|| !take(table.m_values.data(), count*sizeof(double)))
+			return false;
+	}
+
+	m_run = header.m_run;
+	m_sample_count = header.m_sample_count;
+	m_tables = std::move(tables);
+	return true;
+}
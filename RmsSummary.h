@@ -0,0 +1,83 @@
+// David Wilson - Code Sample
+
+#pragma once
+
+#include "Include1.h"
+#include "Include2.h"
+#include "Include3.h"
+
+#include "RmsData.h"
+
+
+//----------------------------------------------------------------------
+// t_rms_summary: Per-component RMS values saved at end of run
+//----------------------------------------------------------------------
+
+// One table per (quantity, window, time step), holding each component's
+// RMS over the run's first sample_count samples, with component ids in
+// info set order so a stale or mismatched table can be refused. The
+// run's identity and sample count are kept so a summary is only used
+// for the run it was written from. Run identity must persist across
+// sessions, e.g. a hash of the run's output, so scenarios of equal
+// length are told apart.
+//
+// File layout: t_file_header, then per table a t_file_table followed by
+// component ids and values.
+
+class t_rms_summary
+{
+public:
+
+	struct t_table
+	{
+		t_rms_quantity				m_quantity = t_rms_quantity::CURRENT;
+		double						m_window = 0;
+		double						m_time_step = 0;
+		std::vector<int64_t>		m_ids;
+		std::vector<double>			m_values;
+	};
+
+	explicit t_rms_summary(uint64_t run = 0, uint64_t sample_count = 0) :
+		m_run(run),
+		m_sample_count(sample_count)
+	{ }
+
+	uint64_t run() const						{ return m_run; }
+	uint64_t sample_count() const				{ return m_sample_count; }
+	const std::vector<t_table>& tables() const	{ return m_tables; }
+
+	void add(t_table table)						{ m_tables.push_back(std::move(table)); }
+
+	// Table for quantity, window and time step, or null
+	const t_table* find(t_rms_quantity quantity, double window, double time_step) const;
+
+	bool save(LPCTSTR path) const;
+	bool load(LPCTSTR path);
+
+private:
+
+	struct t_file_header
+	{
+		static constexpr uint32_t MAGIC		= 0x53534d52;	// "RMSS"
+		static constexpr uint32_t VERSION	= 3;
+
+		uint32_t	m_magic;
+		uint32_t	m_version;
+		uint32_t	m_char_size;
+		uint32_t	m_table_count;
+		uint64_t	m_run;
+		uint64_t	m_sample_count;
+	};
+
+	struct t_file_table
+	{
+		double		m_time_step;
+		double		m_window;
+		int32_t		m_quantity;
+		uint32_t	m_component_count;
+	};
+
+	uint64_t						m_run;
+	uint64_t						m_sample_count;
+	std::vector<t_table>			m_tables;
+};
@@ -0,0 +1,257 @@
+// David Wilson - Code Sample
+
+#pragma once
+
+#include "Include1.h"
+#include "Include2.h"
+#include "Include3.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "RmsData.h"
+
+
+//----------------------------------------------------------------------
+// t_sample_ring: Lock-free single-producer single-consumer step ring
+//----------------------------------------------------------------------
+
+// Each slot holds one simulation step: a sample per component. The
+// producer never waits; if the consumer has fallen a full ring behind,
+// the step is dropped and counted. Producer and consumer indices sit on
+// separate cache lines so neither side's writes invalidate the other's.
+
+class t_sample_ring
+{
+public:
+
+	t_sample_ring(size_t component_count, size_t capacity) :
+		m_component_count(component_count),
+		m_mask(round_up_pow2(capacity) - 1),
+		m_samples((m_mask + 1)*component_count)
+	{ }
+
+	t_sample_ring(const t_sample_ring&) = delete;
+	t_sample_ring& operator=(const t_sample_ring&) = delete;
+
+	size_t component_count() const		{ return m_component_count; }
+	size_t capacity() const				{ return m_mask + 1; }
+	uint64_t dropped() const			{ return m_dropped.load(std::memory_order_relaxed); }
+
+	// Producer: copy one step in, or drop it if ring full
+	bool push(const double* samples)
+	{
+		auto head = m_head.load(std::memory_order_relaxed);
+		if (head - m_tail.load(std::memory_order_acquire) > m_mask)
+		{
+			m_dropped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		std::copy_n(samples, m_component_count, slot(head));
+		m_head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer: oldest unread step, or null if none
+	const double* front() const
+	{
+		auto tail = m_tail.load(std::memory_order_relaxed);
+		if (tail == m_head.load(std::memory_order_acquire)) return nullptr;
+		return slot(tail);
+	}
+
+	// Consumer: release step returned by front
+	void pop()
+	{ m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+	// Consumer: steps waiting
+	size_t size() const
+	{ return size_t(m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_relaxed)); }
+
+private:
+
+	static size_t round_up_pow2(size_t value)
+	{
+		size_t pow2 = 1;
+		while (pow2 < value)
+			pow2 <<= 1;
+		return pow2;
+	}
+
+	double* slot(uint64_t index)
+	{ return m_samples.data() + size_t(index & m_mask)*m_component_count; }
+
+	const double* slot(uint64_t index) const
+	{ return m_samples.data() + size_t(index & m_mask)*m_component_count; }
+
+	const size_t					m_component_count;
+	const size_t					m_mask;
+	std::vector<double>				m_samples;
+	alignas(64) std::atomic<uint64_t>	m_head{ 0 };		// Written by producer
+	alignas(64) std::atomic<uint64_t>	m_tail{ 0 };		// Written by consumer
+	alignas(64) std::atomic<uint64_t>	m_dropped{ 0 };
+};
+
+
+//----------------------------------------------------------------------
+// t_sample_feed: Publishes simulation steps to subscriber rings
+//----------------------------------------------------------------------
+
+// One feed per quantity. Samples in each step follow the feed's
+// component id list. The simulation thread publishes each step to every
+// subscriber's own ring, so subscribers consume at their own rate and a
+// slow one only drops its own steps. Subscribing swaps in a new
+// subscriber list; the publisher takes a snapshot of the list and never
+// waits on a consumer.
+
+class t_sample_feed
+{
+public:
+
+	using t_ring_ptr = std::shared_ptr<t_sample_ring>;
+
+	t_sample_feed(t_rms_quantity quantity, std::vector<t_id> component_ids) :
+		m_quantity(quantity),
+		m_component_ids(std::move(component_ids)),
+		m_component_count(m_component_ids.size()),
+		m_rings(std::make_shared<const t_ring_list>())
+	{ }
+
+	t_rms_quantity quantity() const					{ return m_quantity; }
+	const std::vector<t_id>& component_ids() const	{ return m_component_ids; }
+	size_t component_count() const					{ return m_component_count; }
+
+	// Consumer: new ring receiving steps from now on
+	t_ring_ptr subscribe(size_t capacity)
+	{
+		auto ring = std::make_shared<t_sample_ring>(m_component_count, capacity);
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto rings = std::make_shared<t_ring_list>(*std::atomic_load(&m_rings));
+		rings->push_back(ring);
+		std::atomic_store(&m_rings, std::shared_ptr<const t_ring_list>(rings));
+		return ring;
+	}
+
+	void unsubscribe(const t_ring_ptr& ring)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto rings = std::make_shared<t_ring_list>(*std::atomic_load(&m_rings));
+		rings->erase(std::remove(rings->begin(), rings->end(), ring), rings->end());
+		std::atomic_store(&m_rings, std::shared_ptr<const t_ring_list>(rings));
+	}
+
+	// Producer: one sample per component
+	void publish(const double* samples) const
+	{
+		auto rings = std::atomic_load(&m_rings);
+		for (auto& ring : *rings)
+			ring->push(samples);
+	}
+
+private:
+
+	using t_ring_list = std::vector<t_ring_ptr>;
+
+	const t_rms_quantity			m_quantity;
+	const std::vector<t_id>			m_component_ids;
+	const size_t					m_component_count;
+	std::mutex						m_mutex;		// Serializes subscription changes
+	std::shared_ptr<const t_ring_list>	m_rings;
+};
+
+
+//----------------------------------------------------------------------
+// t_live_channel: One graph's subscription to one quantity feed
+//----------------------------------------------------------------------
+
+// Maps each position in the graph's component list to its index in the
+// feed, so feeds need not list components in graph order. Refused if
+// any graph component is missing from the feed. RMS is kept for every
+// window up to the longest given at subscription, so the window can be
+// switched at once, without waiting for it to refill. Drained and read
+// by the subscribing thread only.
+
+class t_live_channel
+{
+public:
+
+	// Null if feed lacks any of component_ids
+	static std::unique_ptr<t_live_channel> subscribe(
+		t_sample_feed& feed,
+		const std::vector<t_id>& component_ids,
+		size_t window_samples,
+		size_t max_window_samples,
+		size_t ring_steps
+	)
+	{
+		std::unordered_map<t_id, size_t> feed_index;
+		feed_index.reserve(feed.component_count());
+		for (size_t i = 0; i < feed.component_count(); ++i)
+			feed_index.emplace(feed.component_ids()[i], i);
+
+		std::vector<size_t> positions;
+		positions.reserve(component_ids.size());
+		for (auto id : component_ids)
+		{
+			auto index = feed_index.find(id);
+			if (index == feed_index.end())
+				return nullptr;
+			positions.push_back(index->second);
+		}
+		return std::unique_ptr<t_live_channel>(new t_live_channel(feed, component_ids, std::move(positions), window_samples, max_window_samples, ring_steps));
+	}
+
+	t_live_channel(const t_live_channel&) = delete;
+	t_live_channel& operator=(const t_live_channel&) = delete;
+	~t_live_channel()					{ m_feed.unsubscribe(m_ring); }
+
+	const t_sample_feed& feed() const	{ return m_feed; }
+	t_rms_quantity quantity() const		{ return m_feed.quantity(); }
+	uint64_t dropped() const			{ return m_ring->dropped(); }
+
+	// Window in steps, at most longest window subscribed for
+	size_t window() const				{ return m_window; }
+	void set_window(size_t window_samples)
+	{ m_window = std::clamp<size_t>(window_samples, 1, m_rms.capacity()); }
+
+	// Graph components covered, in graph order
+	size_t width() const							{ return m_positions.size(); }
+	const std::vector<t_id>& component_ids() const	{ return m_component_ids; }
+
+	// Fold steps already waiting into window; false if none
+	bool drain()
+	{
+		// Only steps already waiting, so fast producer cannot hold us here
+		auto steps = m_ring->size();
+		for (auto step = steps; step > 0; --step)
+		{
+			m_rms.add_step(m_ring->front());
+			m_ring->pop();
+		}
+		return steps > 0;
+	}
+
+	// Window RMS of graph component at position
+	double rms(size_t position) const	{ return m_rms.rms(m_positions[position], m_window); }
+
+private:
+
+	t_live_channel(t_sample_feed& feed, const std::vector<t_id>& component_ids, std::vector<size_t> positions, size_t window_samples, size_t max_window_samples, size_t ring_steps) :
+		m_feed(feed),
+		m_ring(feed.subscribe(ring_steps)),
+		m_component_ids(component_ids),
+		m_positions(std::move(positions))
+	{
+		m_rms.reset(feed.component_count(), std::max(window_samples, max_window_samples));
+		set_window(window_samples);
+	}
+
+	t_sample_feed&					m_feed;
+	t_sample_feed::t_ring_ptr		m_ring;
+	std::vector<t_id>				m_component_ids;	// Graph order
+	std::vector<size_t>				m_positions;	// Feed index, by graph position
+	t_rms_windows					m_rms;
+	size_t							m_window = 1;
+};
@@ -0,0 +1,203 @@
+// Sample code - David Wilson
+
+#include "Include1.h"
+#include "Include2.h"
+#include "Include3.h"
+
+#include <fstream>
+#include <memory>
+#include <mutex>
+
+#include "Trace.h"
+
+
+// ------------------------------------------------------------------------
+// Trace buffers
+// ------------------------------------------------------------------------
+
+namespace
+{
+	// Events per thread buffer
+	constexpr size_t TRACE_BUFFER_EVENTS = 1 << 16;
+
+	struct t_trace_event
+	{
+		const char*					m_name;
+		const char*					m_category;		// Null for counters
+		int64_t						m_start;
+		int64_t						m_duration;
+		double						m_value;
+		uint32_t					m_thread;
+	};
+
+	// Written only by owning thread; read by dump up to published count
+	struct t_trace_buffer
+	{
+		std::unique_ptr<t_trace_event[]>	m_events{ new t_trace_event[TRACE_BUFFER_EVENTS] };
+		std::atomic<size_t>			m_count{ 0 };
+		std::atomic<uint64_t>		m_dropped{ 0 };
+		bool						m_in_use = false;	// Guarded by registry mutex
+
+		void add(const t_trace_event& event)
+		{
+			auto count = m_count.load(std::memory_order_relaxed);
+			if (count == TRACE_BUFFER_EVENTS)
+			{
+				m_dropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+			m_events[count] = event;
+			m_count.store(count + 1, std::memory_order_release);
+		}
+	};
+
+	struct t_trace_registry
+	{
+		std::mutex					m_mutex;
+		std::vector<std::unique_ptr<t_trace_buffer>>	m_buffers;
+		uint32_t					m_next_thread = 0;
+
+		static t_trace_registry& get()
+		{
+			static t_trace_registry s_registry;
+			return s_registry;
+		}
+	};
+
+	// Thread's hold on a buffer, returned to registry on thread exit
+	class t_trace_thread
+	{
+	public:
+
+		t_trace_thread()
+		{
+			auto& registry = t_trace_registry::get();
+			std::lock_guard<std::mutex> lock(registry.m_mutex);
+			m_id = registry.m_next_thread++;
+
+			// Reuse buffer of exited thread, else add one
+			for (auto& buffer : registry.m_buffers)
+			{
+				if (!buffer->m_in_use)
+				{
+					m_buffer = buffer.get();
+					break;
+				}
+			}
+			if (!m_buffer)
+				m_buffer = registry.m_buffers.emplace_back(std::make_unique<t_trace_buffer>()).get();
+			m_buffer->m_in_use = true;
+		}
+
+		~t_trace_thread()
+		{
+			auto& registry = t_trace_registry::get();
+			std::lock_guard<std::mutex> lock(registry.m_mutex);
+			m_buffer->m_in_use = false;
+		}
+
+		void add(t_trace_event event)
+		{
+			event.m_thread = m_id;
+			m_buffer->add(event);
+		}
+
+	private:
+
+		t_trace_buffer*				m_buffer = nullptr;
+		uint32_t					m_id = 0;
+	};
+
+	t_trace_thread& this_thread_trace()
+	{
+		thread_local t_trace_thread s_thread;
+		return s_thread;
+	}
+
+	// Escape name for JSON string
+	void write_json_string(std::ostream& out, const char* text)
+	{
+		out << '"';
+		for (; *text; ++text)
+		{
+			if (*text == '"' || *text == '\\')
+				out << '\\';
+			out << *text;
+		}
+		out << '"';
+	}
+}
+
+
+// ------------------------------------------------------------------------
+// t_trace
+// ------------------------------------------------------------------------
+
+std::atomic<bool> t_trace::s_enabled(false);
+const std::chrono::steady_clock::time_point t_trace::s_epoch = std::chrono::steady_clock::now();
+
+void t_trace::complete(const char* name, const char* category, int64_t start, int64_t end)
+{
+	this_thread_trace().add({ name, category, start, end - start, 0, 0 });
+}
+
+void t_trace::counter(const char* name, double value)
+{
+	this_thread_trace().add({ name, nullptr, now(), 0, value, 0 });
+}
+
+bool t_trace::dump(const t_char* path)
+{
+	std::ofstream out(path);
+	if (!out)
+		return false;
+
+	// Registry lock keeps buffer list stable; events are read lock-free
+	auto& registry = t_trace_registry::get();
+	std::lock_guard<std::mutex> lock(registry.m_mutex);
+	out << "{\"traceEvents\":[";
+	bool first = true;
+	for (auto& buffer : registry.m_buffers)
+	{
+		auto count = buffer->m_count.load(std::memory_order_acquire);
+		for (size_t i = 0; i < count; ++i)
+		{
+			const auto& event = buffer->m_events[i];
+			out << (first ? "\n" : ",\n") << "{\"name\":";
+			write_json_string(out, event.m_name);
+			if (event.m_category)
+			{
+				out << ",\"cat\":";
+				write_json_string(out, event.m_category);
+				out << ",\"ph\":\"X\",\"ts\":" << event.m_start << ",\"dur\":" << event.m_duration;
+			}
+			else
+				out << ",\"ph\":\"C\",\"ts\":" << event.m_start << ",\"args\":{\"value\":" << event.m_value << "}";
+			out << ",\"pid\":1,\"tid\":" << event.m_thread << "}";
+			first = false;
+		}
+	}
+	out << "\n]}\n";
+	return bool(out);
+}
+
+uint64_t t_trace::dropped()
+{
+	auto& registry = t_trace_registry::get();
+	std::lock_guard<std::mutex> lock(registry.m_mutex);
+	uint64_t dropped = 0;
+	for (auto& buffer : registry.m_buffers)
+		dropped += buffer->m_dropped.load(std::memory_order_relaxed);
+	return dropped;
+}
+
+void t_trace::clear()
+{
+	auto& registry = t_trace_registry::get();
+	std::lock_guard<std::mutex> lock(registry.m_mutex);
+	for (auto& buffer : registry.m_buffers)
+	{
+		buffer->m_count.store(0, std::memory_order_release);
+		buffer->m_dropped.store(0, std::memory_order_relaxed);
+	}
+}
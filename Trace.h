@@ -0,0 +1,110 @@
+// David Wilson - Code Sample
+
+#pragma once
+
+#include "Include1.h"
+#include "Include2.h"
+#include "Include3.h"
+
+#include <atomic>
+#include <chrono>
+
+
+//----------------------------------------------------------------------
+// t_trace: Hot-path timers and counters, dumped as Chrome trace JSON
+//----------------------------------------------------------------------
+
+// Tracing is compiled in unless NO_RMS_TRACE is defined, and is off
+// until enabled. When off, each trace point costs one relaxed load.
+// When on, events go to a fixed buffer owned by the recording thread,
+// with no locks or allocation after the thread's first event. Full
+// buffers drop events and count them. Buffers outlive their threads,
+// and are handed on to later threads, so short-lived batch workers
+// neither lose events nor add buffers. Event names must be string
+// literals, as only the pointer is kept.
+
+class t_trace
+{
+public:
+
+	static void enable(bool enabled)	{ s_enabled.store(enabled, std::memory_order_relaxed); }
+	static bool enabled()				{ return s_enabled.load(std::memory_order_relaxed); }
+
+	// Microseconds since process start
+	static int64_t now()
+	{
+		using namespace std::chrono;
+		return duration_cast<microseconds>(steady_clock::now() - s_epoch).count();
+	}
+
+	static void complete(const char* name, const char* category, int64_t start, int64_t end);
+	static void counter(const char* name, double value);
+
+	// Write all events recorded so far; false if file cannot be written
+	static bool dump(const t_char* path);
+
+	// Events dropped because a buffer was full
+	static uint64_t dropped();
+
+	// Discard recorded events; only while no thread is recording
+	static void clear();
+
+private:
+
+	static std::atomic<bool>		s_enabled;
+	static const std::chrono::steady_clock::time_point	s_epoch;
+};
+
+
+//----------------------------------------------------------------------
+// t_trace_scope: Records time spent in enclosing scope
+//----------------------------------------------------------------------
+
+class t_trace_scope
+{
+public:
+
+	t_trace_scope(const char* name, const char* category) :
+		m_name(name),
+		m_category(category),
+		m_start(t_trace::enabled() ? t_trace::now() : -1)
+	{ }
+
+	t_trace_scope(const t_trace_scope&) = delete;
+	t_trace_scope& operator=(const t_trace_scope&) = delete;
+
+	~t_trace_scope()
+	{
+		if (m_start >= 0)
+			t_trace::complete(m_name, m_category, m_start, t_trace::now());
+	}
+
+private:
+
+	const char*						m_name;
+	const char*						m_category;
+	int64_t							m_start;
+};
+
+
+//----------------------------------------------------------------------
+// Trace macros
+//----------------------------------------------------------------------
+
+#define TRACE_CONCAT2(a, b)			a##b
+#define TRACE_CONCAT(a, b)			TRACE_CONCAT2(a, b)
+
+#ifndef NO_RMS_TRACE
+
+#define TRACE_SCOPE(name, category) \
+	t_trace_scope TRACE_CONCAT(trace_scope_, __LINE__)(name, category)
+
+#define TRACE_COUNTER(name, value) \
+	do { if (t_trace::enabled()) t_trace::counter(name, double(value)); } while (false)
+
+#else
+
+#define TRACE_SCOPE(name, category)	((void)0)
+#define TRACE_COUNTER(name, value)	((void)0)
+
+#endif
@@ -0,0 +1,418 @@
+// Sample code - David Wilson
+
+#include "Include1.h"
+#include "Include2.h"
+#include "Include3.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "Params.h"
+#include "RmsCache.h"
+#include "RmsData.h"
+#include "SampleRing.h"
+
+
+// ------------------------------------------------------------------------
+// Standalone benchmark of RMS graph update pipeline
+// ------------------------------------------------------------------------
+
+// Usage:
+//	RmsBench							Print time and allocations per operation
+//	RmsBench --save <file>				Also write times as baseline
+//	RmsBench --check <file> [<tol>]		Fail if any case is slower than
+//										baseline by more than tol (0.25)
+//
+// Graph phases are swept over 1k to 1M components on synthetic columns.
+// Calculators, info sets and the chart viewer are not in this source, so
+// phases run the graph's own stages around them: a rebuild served from
+// the cache, committing an update column (history and pyramid), fitting
+// axis bounds and sliding-window RMS. Each case reports its best of
+// several repeats, which is the most stable figure on a shared machine,
+// and the heap allocations of one repeat.
+
+namespace
+{
+
+constexpr int REPEATS					= 5;
+constexpr double DEFAULT_TOLERANCE		= 0.25;
+
+// Heap allocations since start, counted by operator new below
+std::atomic<size_t> s_allocations;
+std::atomic<size_t> s_allocated_bytes;
+
+// Defeats dead code elimination of results
+volatile double s_sink;
+
+struct t_bench_case
+{
+	std::string					m_name;
+	size_t						m_ops;			// Operations per run
+	std::function<void()>		m_run;
+};
+
+struct t_bench_result
+{
+	double						m_per_op;		// Best nanoseconds
+	double						m_allocations;	// Per operation
+	double						m_bytes;		// Allocated per operation
+};
+
+t_bench_result time_case(const t_bench_case& bench)
+{
+	t_bench_result result = {};
+	for (int repeat = 0; repeat < REPEATS; ++repeat)
+	{
+		auto allocations = s_allocations.load();
+		auto bytes = s_allocated_bytes.load();
+		auto start = std::chrono::steady_clock::now();
+		bench.m_run();
+		std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+		auto per_op = elapsed.count()/double(bench.m_ops);
+		result.m_per_op			= repeat == 0 ? per_op : std::min(result.m_per_op, per_op);
+		result.m_allocations	= double(s_allocations.load() - allocations)/double(bench.m_ops);
+		result.m_bytes			= double(s_allocated_bytes.load() - bytes)/double(bench.m_ops);
+	}
+	return result;
+}
+
+std::vector<double> random_values(size_t count, unsigned seed)
+{
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<double> value(-100.0, 100.0);
+	std::vector<double> values(count);
+	for (auto& v : values)
+		v = value(random);
+	return values;
+}
+
+t_string bench_string(const std::string& text)
+{
+	return t_string(text.begin(), text.end());
+}
+
+}
+
+void* operator new(size_t size)
+{
+	++s_allocations;
+	s_allocated_bytes += size;
+	if (void* memory = std::malloc(size ? size : 1))
+		return memory;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+	std::free(memory);
+}
+
+
+// ------------------------------------------------------------------------
+// Parameter index over synthetic features
+// ------------------------------------------------------------------------
+
+struct t_bench_feature
+{
+	t_string					m_name;
+};
+
+template<>
+struct t_param_traits<t_bench_feature>
+{
+	static const t_char* to_name(const t_bench_feature* feature)
+	{ return feature->m_name.c_str(); }
+};
+
+
+// ------------------------------------------------------------------------
+// Cases
+// ------------------------------------------------------------------------
+
+namespace
+{
+
+using t_bench_group = std::function<std::vector<t_bench_case>()>;
+
+// Component-steps per graph case, so every size takes similar time
+constexpr size_t WORK					= 1 << 22;
+constexpr size_t MIN_STEPS				= 8;
+constexpr size_t COLUMNS				= 4;			// Distinct synthetic columns
+constexpr size_t BOUNDS_QUERIES			= 1 << 16;
+constexpr size_t WINDOW_CAPACITY		= 8;
+constexpr size_t WINDOW_STEPS			= 4;
+constexpr size_t RING_COMPONENTS		= 64;
+constexpr size_t RING_STEPS				= 1 << 18;
+constexpr size_t CACHE_KEYS				= 1 << 16;
+constexpr size_t FEATURES				= 1 << 14;
+
+const size_t s_component_counts[] = { 1000, 10000, 100000, 1000000 };
+
+std::string size_name(size_t components)
+{
+	return components >= 1000000 ? std::to_string(components/1000000) + "M"
+		: std::to_string(components/1000) + "k";
+}
+
+t_rms_cache_key cache_key(size_t component)
+{
+	return { 1, t_id(component), t_rms_quantity::CURRENT, 0, 0.01, 1 << 20 };
+}
+
+// Graph phases for one component count. Data is made per group, so only
+// one size is held at a time.
+std::vector<t_bench_case> graph_cases(size_t components)
+{
+	std::vector<t_bench_case> cases;
+	auto size = "/" + size_name(components);
+	auto steps = std::max(MIN_STEPS, WORK/components);
+	auto columns = std::make_shared<std::vector<double>>(random_values(components*COLUMNS, unsigned(components)));
+
+	// Rebuild with every initial value already cached, as for a second
+	// graph or report over the same run
+	auto cache = std::make_shared<t_rms_cache>(std::max(t_rms_cache::DEFAULT_BUDGET, components*256));
+	for (size_t component = 0; component < components; ++component)
+		cache->insert(cache_key(component), (*columns)[component]);
+	auto rebuilds = std::max<size_t>(1, steps/MIN_STEPS);
+	cases.push_back({ "rebuild_cached" + size, components*rebuilds, [components, rebuilds, cache]
+	{
+		std::vector<double> column;
+		for (size_t rebuild = 0; rebuild < rebuilds; ++rebuild)
+		{
+			column.clear();
+			column.reserve(components);
+			for (size_t component = 0; component < components; ++component)
+				column.push_back(cache->find(cache_key(component)).value_or(0.0));
+		}
+		s_sink = column.back();
+	}});
+
+	// Update columns committed to whole-run history and zoom pyramid
+	cases.push_back({ "update_commit" + size, components*steps, [components, steps, columns]
+	{
+		t_column_history history;
+		t_minmax_pyramid pyramid;
+		for (size_t step = 0; step < steps; ++step)
+		{
+			auto column = columns->data() + (step % COLUMNS)*components;
+			history.add(column, column + components);
+			pyramid.build(history.latest(), history.width());
+		}
+		s_sink = history.max() - history.min();
+	}});
+
+	// Axis bounds fitted to random zoomed views of latest column
+	auto pyramid = std::make_shared<t_minmax_pyramid>();
+	pyramid->build(columns->data(), components);
+	cases.push_back({ "axis_bounds" + size, BOUNDS_QUERIES, [components, pyramid]
+	{
+		std::mt19937 random(2);
+		std::uniform_int_distribution<size_t> position(0, components - 1);
+		double total = 0;
+		for (size_t query = 0; query < BOUNDS_QUERIES; ++query)
+		{
+			auto a = position(random), b = position(random);
+			auto bounds = pyramid->minmax(std::min(a, b), std::max(a, b) + 1);
+			total += bounds.second - bounds.first;
+		}
+		s_sink = total;
+	}});
+
+	// Sliding-window RMS stepped and read for every component
+	cases.push_back({ "window_rms" + size, components*steps, [components, steps, columns]
+	{
+		t_rms_windows windows;
+		windows.reset(components, WINDOW_CAPACITY);
+		double total = 0;
+		for (size_t step = 0; step < steps; ++step)
+		{
+			windows.add_step(columns->data() + (step % COLUMNS)*components);
+			for (size_t component = 0; component < components; ++component)
+				total += windows.rms(component, WINDOW_STEPS);
+		}
+		s_sink = total;
+	}});
+
+	return cases;
+}
+
+// Helpers with no component count
+std::vector<t_bench_case> helper_cases()
+{
+	std::vector<t_bench_case> cases;
+	auto columns = std::make_shared<std::vector<double>>(random_values(RING_COMPONENTS*16, 3));
+
+	// Producer and consumer threads passing live steps through ring
+	cases.push_back({ "sample_ring_step", RING_STEPS, [columns]
+	{
+		t_sample_ring ring(RING_COMPONENTS, 1024);
+		std::thread producer([&ring, &columns]
+		{
+			for (size_t step = 0; step < RING_STEPS;)
+			{
+				if (ring.push(columns->data() + (step % 16)*RING_COMPONENTS))
+					++step;
+				else
+					std::this_thread::yield();
+			}
+		});
+		double total = 0;
+		for (size_t step = 0; step < RING_STEPS;)
+		{
+			if (auto samples = ring.front())
+			{
+				total += samples[0];
+				ring.pop();
+				++step;
+			}
+			else
+				std::this_thread::yield();
+		}
+		producer.join();
+		s_sink = total;
+	}});
+
+	// Cache filled for one run, as on a first rebuild
+	cases.push_back({ "rms_cache_insert", CACHE_KEYS, []
+	{
+		t_rms_cache cache;
+		for (size_t key = 0; key < CACHE_KEYS; ++key)
+			cache.insert(cache_key(key), double(key));
+		s_sink = double(cache.bytes());
+	}});
+
+	// Batch parameter names resolved through index
+	auto features = std::make_shared<std::vector<t_bench_feature>>(FEATURES);
+	auto pointers = std::make_shared<std::vector<const t_bench_feature*>>();
+	auto names = std::make_shared<std::vector<t_string>>();
+	for (size_t feature = 0; feature < FEATURES; ++feature)
+	{
+		(*features)[feature].m_name = bench_string("Feature " + std::to_string(feature));
+		pointers->push_back(&(*features)[feature]);
+		names->push_back((*features)[feature].m_name);
+	}
+	cases.push_back({ "param_index_build", FEATURES, [features, pointers]
+	{
+		t_param_index<t_bench_feature> index(*pointers);
+		s_sink = double(index.features().size());
+	}});
+	auto index = std::make_shared<t_param_index<t_bench_feature>>(*pointers);
+	cases.push_back({ "param_index_find", FEATURES, [features, index, names]
+	{
+		size_t found = 0;
+		for (auto& name : *names)
+			found += index->find(name) != nullptr;
+		s_sink = double(found);
+	}});
+
+	return cases;
+}
+
+std::vector<t_bench_group> bench_groups()
+{
+	std::vector<t_bench_group> groups;
+	for (auto components : s_component_counts)
+		groups.push_back([components] { return graph_cases(components); });
+	groups.push_back(helper_cases);
+	return groups;
+}
+
+bool read_baseline(const char* path, std::map<std::string, double>& baseline)
+{
+	std::ifstream file(path);
+	if (!file)
+		return false;
+	std::string name;
+	double per_op;
+	while (file >> name >> per_op)
+		baseline[name] = per_op;
+	return true;
+}
+
+}
+
+
+// ------------------------------------------------------------------------
+// main
+// ------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+	// Parse arguments
+	const char* save_path = nullptr;
+	const char* check_path = nullptr;
+	double tolerance = DEFAULT_TOLERANCE;
+	if (argc >= 3 && std::strcmp(argv[1], "--save") == 0)
+		save_path = argv[2];
+	else if (argc >= 3 && std::strcmp(argv[1], "--check") == 0)
+	{
+		check_path = argv[2];
+		if (argc >= 4)
+			tolerance = std::atof(argv[3]);
+	}
+	else if (argc > 1)
+	{
+		std::fprintf(stderr, "usage: RmsBench [--save <file> | --check <file> [<tolerance>]]\n");
+		return 2;
+	}
+
+	// If baseline cannot be read, choke
+	std::map<std::string, double> baseline;
+	if (check_path && !read_baseline(check_path, baseline))
+	{
+		std::fprintf(stderr, "cannot read baseline %s\n", check_path);
+		return 2;
+	}
+
+	// Run cases, comparing each with baseline if checking
+	bool regressed = false;
+	std::ofstream save_file;
+	if (save_path)
+		save_file.open(save_path);
+	std::printf("%-24s %12s %10s %10s %12s\n", "case", "ns/op", "Mop/s", "allocs/op", "bytes/op");
+	for (auto& group : bench_groups())
+	{
+		for (auto& bench : group())
+		{
+			auto result = time_case(bench);
+			std::printf("%-24s %12.2f %10.2f %10.4f %12.2f", bench.m_name.c_str(),
+				result.m_per_op, 1e3/result.m_per_op, result.m_allocations, result.m_bytes);
+			if (save_path)
+				save_file << bench.m_name << ' ' << result.m_per_op << '\n';
+
+			auto entry = baseline.find(bench.m_name);
+			if (entry != baseline.end())
+			{
+				auto ratio = result.m_per_op/entry->second;
+				bool slow = ratio > 1 + tolerance;
+				std::printf("  %6.2fx baseline%s", ratio, slow ? "  REGRESSED" : "");
+				regressed = regressed || slow;
+			}
+			std::printf("\n");
+		}
+	}
+
+	// If results cannot be saved, choke
+	if (save_path && !save_file)
+	{
+		std::fprintf(stderr, "cannot write baseline %s\n", save_path);
+		return 2;
+	}
+	return regressed ? 1 : 0;
+}